@@ -20,6 +20,7 @@
 
 #include "global.h"
 #include "a2d.h"
+#include "isrstat.h"
 
 // global variables
 
@@ -109,6 +110,7 @@ unsigned char a2dConvert8bit(unsigned char ch)
 //! Interrupt handler for ADC complete interrupt.
 SIGNAL(SIG_ADC)
 {
+	ISRSTAT_ENTER(ISRSTAT_ADC);
 	// set the a2d conversion flag to indicate "complete"
 	a2dCompleteFlag = TRUE;
 }
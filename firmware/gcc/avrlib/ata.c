@@ -184,6 +184,83 @@ void ataPrintSector( u08 *Buffer)
 	}
 }
 
+#ifdef ATA_PIO_ASM
+
+// Hand-scheduled PIO kernels.
+// The data register pair is reached through Z with a constant displacement
+// and the buffer through X with post-increment, so each word costs two
+// ldd/st (or ld/std) pairs: 8 cycles plus one per external access when the
+// SRW wait state is on.  The loop body is repeated ATA_PIO_UNROLL times, so
+// the 5 cycle sbiw/breq/rjmp overhead is paid once per ATA_PIO_UNROLL words:
+// about 2127 cycles per sector at the default of 16, 2052 at 256.  An unrolled
+// body is too long for brne to reach back over, hence breq/rjmp.
+// Reading DATAL latches DATAH, and writing DATAL sends the word latched by
+// an earlier DATAH write, so the byte order below must not change.
+
+#ifndef ATA_PIO_UNROLL
+#define ATA_PIO_UNROLL		16
+#endif
+
+#if (ATA_PIO_UNROLL < 1) || (256 % ATA_PIO_UNROLL)
+#error ATA_PIO_UNROLL must divide 256 (words per sector)
+#endif
+
+#define ATA_PIO_STR2(x)		#x
+#define ATA_PIO_STR(x)		ATA_PIO_STR2(x)
+
+void ataReadDataBuffer(u08 *Buffer, u16 numBytes)
+{
+	u16 n = numBytes/(2*ATA_PIO_UNROLL);
+
+	if(!n)
+		return;
+
+	asm volatile (
+		"1:\n\t"
+		".rept " ATA_PIO_STR(ATA_PIO_UNROLL) "\n\t"
+		"ldd __tmp_reg__, Z+%[lo]\n\t"
+		"st X+, __tmp_reg__\n\t"
+		"ldd __tmp_reg__, Z+%[hi]\n\t"
+		"st X+, __tmp_reg__\n\t"
+		".endr\n\t"
+		"sbiw %[n], 1\n\t"
+		"breq 2f\n\t"
+		"rjmp 1b\n\t"
+		"2:\n\t"
+		: "+x" (Buffer), [n] "+w" (n)
+		: "z" (ATA_REG_BASE), [lo] "I" (ATA_REG_DATAL), [hi] "I" (ATA_REG_DATAH)
+		: "memory"
+	);
+}
+
+void ataWriteDataBuffer(u08 *Buffer, u16 numBytes)
+{
+	u16 n = numBytes/(2*ATA_PIO_UNROLL);
+	u08 temp;
+
+	if(!n)
+		return;
+
+	asm volatile (
+		"1:\n\t"
+		".rept " ATA_PIO_STR(ATA_PIO_UNROLL) "\n\t"
+		"ld __tmp_reg__, X+\n\t"
+		"ld %[t], X+\n\t"
+		"std Z+%[hi], %[t]\n\t"
+		"std Z+%[lo], __tmp_reg__\n\t"
+		".endr\n\t"
+		"sbiw %[n], 1\n\t"
+		"breq 2f\n\t"
+		"rjmp 1b\n\t"
+		"2:\n\t"
+		: "+x" (Buffer), [n] "+w" (n), [t] "=&r" (temp)
+		: "z" (ATA_REG_BASE), [lo] "I" (ATA_REG_DATAL), [hi] "I" (ATA_REG_DATAH)
+		: "memory"
+	);
+}
+
+#else
+
 void ataReadDataBuffer(u08 *Buffer, u16 numBytes)
 {
 	unsigned int i;
@@ -256,6 +333,8 @@ void ataWriteDataBuffer(u08 *Buffer, u16 numBytes)
 
 }
 
+#endif
+
 u08 ataStatusWait(u08 mask, u08 waitStatus)
 {
 	register u08 status;
@@ -300,11 +379,16 @@ unsigned char ataReadSectorsCHS(	unsigned char Drive,
 		return 1;
 	}
 
-	// Wait for drive to request data transfer
-	ataStatusWait(ATA_SR_DRQ, 0);
-
 	// read data from drive
-	ataReadDataBuffer(Buffer, 512*numsectors);
+	// (the drive raises DRQ for each sector once it has it buffered, so
+	// reading a multi-sector transfer in one go runs ahead of the data)
+	while(numsectors--)
+	{
+		// Wait for drive to request data transfer
+		ataStatusWait(ATA_SR_DRQ, 0);
+		ataReadDataBuffer(Buffer, 512);
+		Buffer += 512;
+	}
 
 	// Return the error bit from the status register...
 	temp = ataReadByte(ATA_REG_CMDSTATUS1);	// read status register
@@ -337,11 +421,14 @@ unsigned char ataWriteSectorsCHS(unsigned char Drive,
 
 	//delay(100);
 
-	// Wait for drive to request data transfer
-	ataStatusWait(ATA_SR_DRQ, 0);
-
-	// write data to drive
-	ataWriteDataBuffer(Buffer, 512*numsectors);
+	// write data to drive, a sector each time the drive requests one
+	while(numsectors--)
+	{
+		// Wait for drive to request data transfer
+		ataStatusWait(ATA_SR_DRQ, 0);
+		ataWriteDataBuffer(Buffer, 512);
+		Buffer += 512;
+	}
 	
 	// Wait for drive to finish write
 	temp = ataStatusWait(ATA_SR_BSY, ATA_SR_BSY);
@@ -509,6 +596,50 @@ unsigned char ataWriteSectors(unsigned char Drive,
 	return temp;
 }                            		
 
+// block device operations
+// (the sector count register is 8 bits wide, so long requests are split)
+#define ATA_MAX_SECTORS		255
+
+static u08 ataBlockRead(BlockDev* dev, u32 block, u16 count, u08* buffer)
+{
+	u08 n;
+
+	while(count)
+	{
+		n = (count > ATA_MAX_SECTORS) ? ATA_MAX_SECTORS : count;
+		if(ataReadSectors(dev->unit, block, n, buffer))
+			return 1;
+		block += n;
+		buffer += (u16)n << 9;
+		count -= n;
+	}
+	return 0;
+}
+
+static u08 ataBlockWrite(BlockDev* dev, u32 block, u16 count, u08* buffer)
+{
+	u08 n;
+
+	while(count)
+	{
+		n = (count > ATA_MAX_SECTORS) ? ATA_MAX_SECTORS : count;
+		if(ataWriteSectors(dev->unit, block, n, buffer))
+			return 1;
+		block += n;
+		buffer += (u16)n << 9;
+		count -= n;
+	}
+	return 0;
+}
+
+const BlockDevOps ataBlockDevOps = {ataBlockRead, ataBlockWrite, 0};
+
+void ataBlockDevInit(BlockDev* dev, unsigned char Drive)
+{
+	blockdevInit(dev, &ataBlockDevOps, ataDriveInfo.sizeinsectors);
+	dev->unit = Drive;
+}
+
 void ataDriveSelect(u08 DriveNo)
 {
 	ataWriteByte(ATA_REG_HDDEVSEL, 0xA0+(DriveNo ? 0x10:00)); // Drive selection
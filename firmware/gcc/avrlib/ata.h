@@ -38,6 +38,7 @@
 
 #include "global.h"
 #include "ataconf.h"
+#include "blockdev.h"
 
 // constants
 #define DRIVE0		0
@@ -188,6 +189,11 @@ unsigned char ataWriteSectors(	unsigned char Drive,
 								unsigned int numsectors,
                             	unsigned char *Buffer);
 
+//! Block device operations for ATA drives (see blockdev.h).
+extern const BlockDevOps ataBlockDevOps;
+//! Sets up a block device for an ATA drive (call after ataDriveInit()).
+void ataBlockDevInit(BlockDev* dev, unsigned char Drive);
+
 //unsigned char IdentifyDrive(unsigned char DriveNo,  unsigned char *Buffer, tdefDriveInfo *DriveInfo);
 //unsigned char SetMode(unsigned char DriveNo, unsigned char Mode, unsigned char PwrDown);
 //unsigned char ATA_Idle(unsigned char Drive);
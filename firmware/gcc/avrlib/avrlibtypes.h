@@ -33,8 +33,15 @@ typedef unsigned char  u08;
 typedef   signed char  s08;
 typedef unsigned short u16;
 typedef   signed short s16;
+#if defined(__AVR__) || defined(WIN32)
 typedef unsigned long  u32;
 typedef   signed long  s32;
+#else
+// other hosts (e.g. when testing library code on a PC) may have 64-bit longs
+#include <stdint.h>
+typedef uint32_t       u32;
+typedef  int32_t       s32;
+#endif
 typedef unsigned long long u64;
 typedef   signed long long s64;
 
@@ -68,8 +75,13 @@ typedef   signed long	int64_t;
 	// more type redefinitions
 	typedef unsigned char   BOOL;
 	typedef unsigned char	BYTE;
+	#ifdef __AVR__
 	typedef unsigned int	WORD;
 	typedef unsigned long	DWORD;
+	#else
+	typedef u16				WORD;
+	typedef u32				DWORD;
+	#endif
 
 	typedef unsigned char	UCHAR;
 	typedef unsigned int	UINT;
@@ -0,0 +1,91 @@
+/*! \file blockdev.c \brief Block device interface. */
+//*****************************************************************************
+//
+// File Name	: 'blockdev.c'
+// Title		: Block device interface
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include "global.h"
+#include "blockdev.h"
+
+// check that a request lies within a device of known size
+static u08 blockdevInRange(BlockDev* dev, u32 block, u16 count)
+{
+	return !dev->blocks || ((block < dev->blocks) && (count <= dev->blocks - block));
+}
+
+void blockdevInit(BlockDev* dev, const BlockDevOps* ops, u32 blocks)
+{
+	// attach device operations
+	dev->ops = ops;
+	dev->blocks = blocks;
+	dev->unit = 0;
+	dev->priv = 0;
+	// reset statistics
+	blockdevClearStats(dev);
+}
+
+u08 blockdevRead(BlockDev* dev, u32 block, u16 count, u08* buffer)
+{
+	u08 result;
+
+	if(blockdevInRange(dev, block, count))
+		result = dev->ops->read(dev, block, count, buffer);
+	else
+		result = 1;
+
+	dev->stats.reads++;
+	if(result)
+		dev->stats.errors++;
+	else
+		dev->stats.blocksRead += count;
+	return result;
+}
+
+u08 blockdevWrite(BlockDev* dev, u32 block, u16 count, u08* buffer)
+{
+	u08 result;
+
+	if(blockdevInRange(dev, block, count))
+		result = dev->ops->write(dev, block, count, buffer);
+	else
+		result = 1;
+
+	dev->stats.writes++;
+	if(result)
+		dev->stats.errors++;
+	else
+		dev->stats.blocksWritten += count;
+	return result;
+}
+
+u08 blockdevSync(BlockDev* dev)
+{
+	if(dev->ops->sync)
+		return dev->ops->sync(dev);
+	return 0;
+}
+
+BlockDevStats* blockdevGetStats(BlockDev* dev)
+{
+	return &dev->stats;
+}
+
+void blockdevClearStats(BlockDev* dev)
+{
+	dev->stats.reads = 0;
+	dev->stats.writes = 0;
+	dev->stats.blocksRead = 0;
+	dev->stats.blocksWritten = 0;
+	dev->stats.errors = 0;
+}
@@ -0,0 +1,120 @@
+/*! \file blockdev.h \brief Block device interface. */
+//*****************************************************************************
+//
+// File Name	: 'blockdev.h'
+// Title		: Block device interface
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+///	\ingroup general
+/// \defgroup blockdev Block Device Interface (blockdev.c)
+/// \code #include "blockdev.h" \endcode
+/// \par Overview
+///		A common interface to storage made of 512-byte blocks, so that the
+///		filesystem code can run on any of them.  Each driver exports a table
+///		of block operations (BlockDevOps), and a BlockDev descriptor binds a
+///		table to the unit it drives, its size and a block of statistics.
+///		Backends are provided by ata.c (ataBlockDevInit), mmc.c
+///		(mmcBlockDevInit), spiflash.c (spiflashBlockDevInit) and, for
+///		testing on a PC, blockdevfile.c (blockdevFileOpen) which uses a disk
+///		image file.
+///	\code
+/// BlockDev card;
+///
+/// mmcInit();
+/// mmcReset();
+/// mmcBlockDevInit(&card);
+/// fatInit(&card);
+/// \endcode
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+//@{
+
+#ifndef BLOCKDEV_H
+#define BLOCKDEV_H
+
+#include "global.h"
+
+// constants
+#define BLOCKDEV_BLOCKSIZE		512		///< bytes per block
+
+// structure/typdefs
+
+typedef struct struct_BlockDev BlockDev;
+
+//! Block device operations table.
+/// Each storage driver provides one of these.  The operations return zero
+/// if successful, like the drivers' own read/write functions.
+typedef struct struct_BlockDevOps
+{
+	u08 (*read)(BlockDev* dev, u32 block, u16 count, u08* buffer);		///< read count blocks
+	u08 (*write)(BlockDev* dev, u32 block, u16 count, u08* buffer);	///< write count blocks
+	u08 (*sync)(BlockDev* dev);		///< finish pending writes (0 if not needed)
+} BlockDevOps;
+
+//! Per-device statistics.
+typedef struct struct_BlockDevStats
+{
+	u32 reads;				///< read requests
+	u32 writes;				///< write requests
+	u32 blocksRead;			///< blocks read
+	u32 blocksWritten;		///< blocks written
+	u16 errors;				///< failed requests
+} BlockDevStats;
+
+//! Block device descriptor.
+struct struct_BlockDev
+{
+	const BlockDevOps* ops;	///< device operations
+	u32 blocks;				///< device size in blocks (0 if unknown)
+	u08 unit;				///< unit number within the driver (e.g. ATA drive)
+	void* priv;				///< driver private data
+	BlockDevStats stats;	///< statistics
+};
+
+// functions
+
+//! Initialize a block device descriptor to use the given device operations.
+void blockdevInit(BlockDev* dev, const BlockDevOps* ops, u32 blocks);
+
+//! Read count blocks starting at block into buffer.
+/// Returns zero if successful.
+u08 blockdevRead(BlockDev* dev, u32 block, u16 count, u08* buffer);
+
+//! Write count blocks starting at block from buffer.
+/// Returns zero if successful.
+u08 blockdevWrite(BlockDev* dev, u32 block, u16 count, u08* buffer);
+
+//! Finish any writes the device has pending.
+/// Returns zero if successful.
+u08 blockdevSync(BlockDev* dev);
+
+//! Returns the device size in blocks (0 if unknown).
+static inline u32 blockdevGetBlocks(BlockDev* dev)
+{
+	return dev->blocks;
+}
+
+//! Returns pointer to the device's statistics.
+BlockDevStats* blockdevGetStats(BlockDev* dev);
+
+//! Clear the device's statistics.
+void blockdevClearStats(BlockDev* dev);
+
+#ifndef __AVR__
+//! Opens a disk image file as a block device (PC builds only, blockdevfile.c).
+/// Returns zero if successful.
+u08 blockdevFileOpen(BlockDev* dev, const char* filename);
+//! Closes a disk image opened with blockdevFileOpen().
+void blockdevFileClose(BlockDev* dev);
+#endif
+
+#endif
+//@}
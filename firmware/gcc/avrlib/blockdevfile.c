@@ -0,0 +1,77 @@
+/*! \file blockdevfile.c \brief Block device backend for disk image files. */
+//*****************************************************************************
+//
+// File Name	: 'blockdevfile.c'
+// Title		: Block device backend for disk image files
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: PC (Linux, for testing)
+// Editor Tabs	: 4
+//
+// Lets the filesystem code be run and measured on a PC against FAT16/32
+// images made with the usual tools (mkfs.vfat, mtools, dd of a real card).
+// Build it with the host compiler together with blockdev.c and fat.c.
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef __AVR__
+
+#include <stdio.h>
+
+#include "global.h"
+#include "blockdev.h"
+
+static u08 blockdevFileRead(BlockDev* dev, u32 block, u16 count, u08* buffer)
+{
+	FILE* file = (FILE*) dev->priv;
+
+	if(fseek(file, (long)block*BLOCKDEV_BLOCKSIZE, SEEK_SET))
+		return 1;
+	if(fread(buffer, BLOCKDEV_BLOCKSIZE, count, file) != count)
+		return 1;
+	return 0;
+}
+
+static u08 blockdevFileWrite(BlockDev* dev, u32 block, u16 count, u08* buffer)
+{
+	FILE* file = (FILE*) dev->priv;
+
+	if(fseek(file, (long)block*BLOCKDEV_BLOCKSIZE, SEEK_SET))
+		return 1;
+	if(fwrite(buffer, BLOCKDEV_BLOCKSIZE, count, file) != count)
+		return 1;
+	return 0;
+}
+
+static u08 blockdevFileSync(BlockDev* dev)
+{
+	return fflush((FILE*) dev->priv) ? 1 : 0;
+}
+
+static const BlockDevOps blockdevFileOps = {blockdevFileRead, blockdevFileWrite, blockdevFileSync};
+
+u08 blockdevFileOpen(BlockDev* dev, const char* filename)
+{
+	FILE* file;
+
+	// open for update, or read-only if that is all that is allowed
+	if( !(file = fopen(filename, "r+b")) && !(file = fopen(filename, "rb")) )
+		return 1;
+	fseek(file, 0, SEEK_END);
+	blockdevInit(dev, &blockdevFileOps, ftell(file)/BLOCKDEV_BLOCKSIZE);
+	dev->priv = file;
+	return 0;
+}
+
+void blockdevFileClose(BlockDev* dev)
+{
+	fclose((FILE*) dev->priv);
+	dev->priv = 0;
+}
+
+#endif
@@ -18,6 +18,7 @@
 #include "buffer.h"
 #include "global.h"
 #include "avr/io.h"
+#include "isrstat.h"
 
 #ifndef CRITICAL_SECTION_START
 #define CRITICAL_SECTION_START	unsigned char _sreg = SREG; cli()
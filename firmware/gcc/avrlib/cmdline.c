@@ -76,6 +76,8 @@ CmdlineFuncPtrType CmdlineExecFunction;
 
 // function pointer to single character output routine
 static void (*cmdlineOutputFunc)(unsigned char c);
+// output stream (when set with cmdlineSetOutputStream)
+static Stream* cmdlineOutputStream;
 
 void cmdlineInit(void)
 {
@@ -110,6 +112,27 @@ void cmdlineSetOutputFunc(void (*output_func)(unsigned char c))
 	//cmdlinePrintPrompt();
 }
 
+// character output routine for stream output
+static void cmdlineStreamOutputFunc(unsigned char c)
+{
+	streamWrite(cmdlineOutputStream, c);
+}
+
+void cmdlineSetOutputStream(Stream* stream)
+{
+	// set new output stream
+	cmdlineOutputStream = stream;
+	cmdlineOutputFunc = cmdlineStreamOutputFunc;
+}
+
+void cmdlineInputStream(Stream* stream)
+{
+	int c;
+	// process all characters waiting in the stream
+	while((c = streamRead(stream)) >= 0)
+		cmdlineInputFunc(c);
+}
+
 void cmdlineInputFunc(unsigned char c)
 {
 	u08 i;
@@ -80,6 +80,7 @@
 #define CMDLINE_H
 
 #include "global.h"
+#include "stream.h"
 
 // constants/macros/typdefs
 typedef void (*CmdlineFuncPtrType)(void);
@@ -98,9 +99,15 @@ void cmdlineAddCommand(u08* newCmdString, CmdlineFuncPtrType newCmdFuncPtr);
 //! sets the function used for sending characters to the user terminal
 void cmdlineSetOutputFunc(void (*output_func)(unsigned char c));
 
+//! sets a byte-stream used for sending characters to the user terminal
+void cmdlineSetOutputStream(Stream* stream);
+
 //! call this function to pass input charaters from the user terminal
 void cmdlineInputFunc(unsigned char c);
 
+//! call this function to pass all waiting input from a byte-stream
+void cmdlineInputStream(Stream* stream);
+
 //! call this function in your program's main loop
 void cmdlineMainLoop(void);
 
@@ -41,4 +41,11 @@
 
 #define ATA_REG_DATAH		0x10
 
+// define ATA_PIO_ASM to use the hand-scheduled inline assembly
+// sector transfer loops instead of the C versions
+//#define ATA_PIO_ASM
+// words moved per loop pass by the assembly loops (must divide 256);
+// 256 unrolls a whole sector, at a cost of about 2K of flash per direction
+//#define ATA_PIO_UNROLL		16
+
 #endif
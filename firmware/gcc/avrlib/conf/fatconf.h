@@ -25,16 +25,30 @@
 // debug on/off
 #define DEBUG_FAT
 
-#define SECTOR_BUFFER1_ADDR			0x0600+0x0600
-#define SECTOR_BUFFER1_SIZE			0x0200
+#define FAT_FILENAME_BUFFER_ADDR	0x0200+0x0600
+#define FAT_FILENAME_BUFFER_SIZE	0x0100
 
-#define LONGNAME_BUFFER_ADDR		0x0200+0x0600
-#define LONGNAME_BUFFER_SIZE		0x0100
+#define FAT_PATHNAME_BUFFER_ADDR	0x0300+0x0600
+#define FAT_PATHNAME_BUFFER_SIZE	0x0100
 
-#define DIRNAME_BUFFER_ADDR			0x0300+0x0600
-#define DIRNAME_BUFFER_SIZE			0x0100
+// directory and FAT sectors are read through the sector cache, which is
+// sized in global.h (see seccache.h: SECCACHE_ENTRIES, SECCACHE_BUFFER_ADDR)
 
-#define FAT_CACHE_ADDR				0x0400+0x0600
-#define FAT_CACHE_SIZE				0x0200
+// number of cluster runs (extents) cached per open file (6 bytes each)
+#define FAT_FILE_EXTENTS			8
+
+// define FAT_WRITE to compile in appending to files (fatWriteOpen, fatWrite,
+// fatWriteSync); each writer holds up to FAT_WRITE_PENDING new clusters
+// between FAT updates
+#define FAT_WRITE
+#define FAT_WRITE_PENDING			4
+
+// directory index
+// define FAT_DIR_INDEX to keep a one-byte hash of each name in the current
+// directory (built on its first scan) for fast fatFindEntry() lookups, and
+// the position of every FAT_DIR_INDEX_STEP'th entry for fast seeks
+#define FAT_DIR_INDEX
+#define FAT_DIR_INDEX_SIZE			128		// entries indexed (1 byte each)
+#define FAT_DIR_INDEX_STEP			16		// entries per seek position (17 bytes each)
 
 #endif
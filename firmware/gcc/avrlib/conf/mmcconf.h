@@ -30,4 +30,9 @@
 #define MMC_CS_DDR			DDRB
 #define MMC_CS_PIN			0
 
+// SPI clock while the card is initialized (must be 100-400kHz)
+#define MMC_INIT_CLOCK		SPI_CLK_DIV128
+// SPI clock once the card is ready (cards accept up to 25MHz)
+#define MMC_CLOCK			SPI_CLK_DIV2
+
 #endif
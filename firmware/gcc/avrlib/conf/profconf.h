@@ -0,0 +1,31 @@
+/*! \file profconf.h \brief PC-Sampling Profiler Configuration. */
+//*****************************************************************************
+//
+// File Name	: 'profconf.h'
+// Title		: PC-Sampling Profiler Configuration
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef PROFCONF_H
+#define PROFCONF_H
+
+// Profiler Configuration Options
+
+// Each histogram bucket covers 2^PROF_BUCKET_SHIFT program words
+// (6 = 64 words = 128 bytes of flash per bucket)
+#define PROF_BUCKET_SHIFT	6
+
+// Number of histogram buckets, 2 bytes of RAM each
+// (64 buckets of 128 bytes covers the 8K flash of an ATmega8)
+#define PROF_BUCKETS		64
+
+#endif
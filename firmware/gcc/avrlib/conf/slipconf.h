@@ -0,0 +1,29 @@
+/*! \file slipconf.h \brief SLIP Framed Packet Transport Configuration. */
+//*****************************************************************************
+//
+// File Name	: 'slipconf.h'
+// Title		: SLIP Framed Packet Transport Configuration
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: any
+// Editor Tabs	: 4
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef SLIPCONF_H
+#define SLIPCONF_H
+
+// SLIP Configuration Options
+
+// This determines the size of the Packet Receive Buffer
+// where received packets are decoded (type + data + 2 byte CRC).
+// Longer packets are discarded.  This is the only RAM the
+// receiver uses besides the serial port's own receive buffer.
+#define SLIP_MAXRXPACKETSIZE	64	// length of packet buffer
+
+#endif
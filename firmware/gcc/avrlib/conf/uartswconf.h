@@ -56,6 +56,13 @@
 #define UARTSW_TX_DDR			DDRD	///< UART Transmit DDR
 #define UARTSW_TX_PIN			PD5		///< UART Transmit Pin
 
+// define to transmit on the Timer1 OC1A pin using the output compare
+// hardware to make the bit edges (UARTSW_TX_PIN must then be OC1A)
+//#define UARTSW_TX_OC1A
+
+// define to record worst-case bit service latency (see uartswGetJitter)
+//#define UARTSW_JITTER_STATS
+
 // UART receive pin defines
 // This pin must correspond to the
 // Timer1 Input Capture (ICP or IC1) pin for your processor
@@ -0,0 +1,116 @@
+/*! \file delay.h \brief Cycle-counted busy-wait delays. */
+//*****************************************************************************
+//
+// File Name	: 'delay.h'
+// Title		: Cycle-counted busy-wait delays
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+///	\ingroup general
+/// \defgroup delay Cycle-Counted Delays (delay.h)
+/// \code #include "delay.h" \endcode
+/// \par Overview
+///		Busy-wait delays computed from F_CPU at compile time.  When the delay
+///		is a constant (as it nearly always is in device drivers), the number
+///		of CPU cycles is worked out by the compiler and the delay is a single
+///		loop with a known cost per pass, accurate to a cycle with avr-gcc 4.7
+///		or newer (__builtin_avr_delay_cycles), and to a cycle or two per
+///		262144 cycles with older compilers.  Delays are rounded up, so they
+///		are never shorter than asked for.
+///	\par
+///		A non-constant delay uses a run-time loop that is never shorter than
+///		asked for, but may be longer by the few dozen cycles it takes to set
+///		up the loop.
+///	\par
+///		Interrupts that occur during a busy-wait delay make it longer.
+///		These functions are included by the timer libraries, so there is
+///		normally no need to include this file directly.
+///
+/// \warning F_CPU must be set correctly in \c global.h.
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+//@{
+
+#ifndef DELAY_H
+#define DELAY_H
+
+#include "global.h"
+
+// CPU cycles for a delay, rounded up
+#define DELAY_US_CYCLES(us)		((((u32)(us))*(F_CPU/1000) + 999)/1000)
+#define DELAY_MS_CYCLES(ms)		(((u32)(ms))*(F_CPU/1000))
+// 4-cycle loops per microsecond in 8.8 fixed-point, rounded up
+#define DELAY_LOOPS_PER_US_Q8	(((F_CPU/1000)*64 + 999)/1000)
+
+//! Delays for a constant number of CPU cycles.
+#if (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 7))
+#define delay_cycles(cycles)	__builtin_avr_delay_cycles(cycles)
+#else
+static inline void delay_cycles(u32 cycles) __attribute__((always_inline));
+static inline void delay_cycles(u32 cycles)
+{
+	u16 n;
+
+	// sbiw/brne loops of 4 cycles each
+	while(cycles > 4UL*65535)
+	{
+		n = 65535;
+		asm volatile ("1: sbiw %0,1" "\n\t" "brne 1b" : "=w" (n) : "0" (n));
+		cycles -= 4UL*65535;
+	}
+	n = cycles>>2;
+	if(n)
+		asm volatile ("1: sbiw %0,1" "\n\t" "brne 1b" : "=w" (n) : "0" (n));
+	// odd cycles
+	if(cycles & 2)
+		asm volatile ("rjmp .+0");
+	if(cycles & 1)
+		asm volatile ("nop");
+}
+#endif
+
+//! Run-time microsecond delay (use delay_us() instead).
+static inline void delay_us_var(u16 us)
+{
+	u32 loops;
+	u16 n;
+
+	// no division: loops = us * loops-per-us
+	loops = ((u32)us * DELAY_LOOPS_PER_US_Q8) >> 8;
+	while(loops)
+	{
+		n = (loops > 65535)?(65535):(loops);
+		loops -= n;
+		asm volatile ("1: sbiw %0,1" "\n\t" "brne 1b" : "=w" (n) : "0" (n));
+	}
+}
+
+//! Run-time millisecond delay (use delay_ms_busy() instead).
+static inline void delay_ms_busy_var(u16 ms)
+{
+	// the loop itself takes a few cycles per pass
+	while(ms--)
+		delay_cycles(DELAY_MS_CYCLES(1) - 8);
+}
+
+//! Delays for at least \c us microseconds (0-65535).
+#define delay_us(us)		(__builtin_constant_p(us) ? \
+								delay_cycles(DELAY_US_CYCLES(us)) : \
+								delay_us_var(us))
+
+//! Busy-waits for at least \c ms milliseconds (0-65535).
+/// Unlike delay_ms(), which sleeps on the timer, this needs no timer
+/// or interrupts, so it can be used during initialization.
+#define delay_ms_busy(ms)	(__builtin_constant_p(ms) ? \
+								delay_cycles(DELAY_MS_CYCLES(ms)) : \
+								delay_ms_busy_var(ms))
+
+#endif
+//@}
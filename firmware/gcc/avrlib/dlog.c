@@ -0,0 +1,79 @@
+/*! \file dlog.c \brief Deferred binary logging over SLIP. */
+//*****************************************************************************
+//
+// File Name	: 'dlog.c'
+// Title		: Deferred binary logging over SLIP
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <avr/pgmspace.h>
+
+#include "global.h"
+#include "slip.h"
+#include "dlog.h"
+
+// timestamp source
+static u16 (*dlogTimestamp)(void);
+
+// functions
+
+void dlogInit(u16 (*timestamp_func)(void))
+{
+	dlogTimestamp = timestamp_func;
+}
+
+void dlogRecord(const prog_char* fmt, u08 nbytes, const void* args)
+{
+	u16 header[2];
+
+	// the format string's flash address is its ID
+	header[0] = (u16)fmt;
+	header[1] = dlogTimestamp?dlogTimestamp():0;
+
+	// send the record
+	slipSendBegin(DLOG_PACKET_TYPE);
+	slipSendData(sizeof(header), (u08*)header);
+	slipSendData(nbytes, (u08*)args);
+	slipSendEnd();
+}
+
+void dlogPrint0(const prog_char* fmt)
+{
+	dlogRecord(fmt, 0, 0);
+}
+
+void dlogPrint1(const prog_char* fmt, u16 a)
+{
+	dlogRecord(fmt, sizeof(a), &a);
+}
+
+void dlogPrint2(const prog_char* fmt, u16 a, u16 b)
+{
+	u16 args[2];
+	args[0] = a;
+	args[1] = b;
+	dlogRecord(fmt, sizeof(args), args);
+}
+
+void dlogPrint3(const prog_char* fmt, u16 a, u16 b, u16 c)
+{
+	u16 args[3];
+	args[0] = a;
+	args[1] = b;
+	args[2] = c;
+	dlogRecord(fmt, sizeof(args), args);
+}
+
+void dlogPrintL(const prog_char* fmt, u32 a)
+{
+	dlogRecord(fmt, sizeof(a), &a);
+}
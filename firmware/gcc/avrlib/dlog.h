@@ -0,0 +1,98 @@
+/*! \file dlog.h \brief Deferred binary logging over SLIP. */
+//*****************************************************************************
+//
+// File Name	: 'dlog.h'
+// Title		: Deferred binary logging over SLIP
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+///	\ingroup general
+/// \defgroup dlog Deferred Binary Logging (dlog.c)
+/// \code #include "dlog.h" \endcode
+/// \par Overview
+///		This library logs diagnostic messages without formatting them on the
+///		processor.  Instead of sending the text, each log call sends a short
+///		binary record holding an ID for the format string, a timestamp and the
+///		raw argument values.  The text is put back together on the PC.  A
+///		typical record is 6-10 bytes (plus SLIP framing) instead of 30-60
+///		characters of formatted text, and costs no number conversion on the
+///		processor.
+///	\par
+///		The format string is stored in program memory like a PSTR(), and
+///		its flash address is the string ID.  The ID is fixed by the linker at
+///		build time, so no ID table has to be maintained by hand: the PC side
+///		looks the string up at that address in the .elf (or in a dictionary
+///		dumped from it, e.g. with avr-objdump) of the firmware that is running.
+///	\par
+///		Records are sent as SLIP packets (see slip.h) of type DLOG_PACKET_TYPE,
+///		so they can share the serial link with other packet traffic.  Call
+///		slipInit() before logging.  The packet data is (all little-endian):
+///
+///		[id lo][id hi][timestamp lo][timestamp hi][argument bytes...]
+///
+///		Arguments are sent in order, 2 bytes for each 16-bit argument and 4
+///		bytes for a 32-bit one.  The PC decoder takes the size from the
+///		format string: %d %u %x %c take 2 bytes, %ld %lu %lx take 4.
+///		Records from dlogData() carry a raw block of bytes which the
+///		decoder prints in hex.
+///	\code
+/// slipInit(uartSendByte);
+/// dlogInit(myTickCount);
+/// ...
+/// dlog2("adc ch%d = %u", channel, value);
+/// \endcode
+///	\note The log functions are not reentrant.  Do not log from an
+///		interrupt and from the main loop at the same time, or records will
+///		be interleaved on the wire (the CRC will catch it, and both records
+///		will be dropped).
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+//@{
+
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <avr/pgmspace.h>
+#include "global.h"
+
+#ifndef DLOG_PACKET_TYPE
+//! SLIP packet type used for log records.
+/// Override in your project's global.h if it clashes with another protocol.
+#define DLOG_PACKET_TYPE	'L'
+#endif
+
+// functions
+
+//! Initializes the logging library.
+/// \param timestamp_func	function returning the current time in any unit
+///							(e.g. system ticks), or 0 for no timestamps.
+///							Only the low 16 bits are sent; the PC unwraps them.
+void dlogInit(u16 (*timestamp_func)(void));
+
+//! Sends a log record with arbitrary argument bytes.
+/// Normally used through the macros below.
+void dlogRecord(const prog_char* fmt, u08 nbytes, const void* args);
+
+void dlogPrint0(const prog_char* fmt);					///< log record with no arguments
+void dlogPrint1(const prog_char* fmt, u16 a);			///< log record with one 16-bit argument
+void dlogPrint2(const prog_char* fmt, u16 a, u16 b);	///< log record with two 16-bit arguments
+void dlogPrint3(const prog_char* fmt, u16 a, u16 b, u16 c);	///< log record with three 16-bit arguments
+void dlogPrintL(const prog_char* fmt, u32 a);			///< log record with one 32-bit argument
+
+// macros to keep the format string in program memory
+#define dlog0(format)				dlogPrint0(PSTR(format))
+#define dlog1(format, a)			dlogPrint1(PSTR(format), (a))
+#define dlog2(format, a, b)			dlogPrint2(PSTR(format), (a), (b))
+#define dlog3(format, a, b, c)		dlogPrint3(PSTR(format), (a), (b), (c))
+#define dlogL(format, a)			dlogPrintL(PSTR(format), (a))
+#define dlogData(format, ptr, len)	dlogRecord(PSTR(format), (len), (ptr))
+
+#endif
+//@}
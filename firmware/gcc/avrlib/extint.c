@@ -30,20 +30,30 @@
 
 #include "global.h"
 #include "extint.h"
+#include "isrstat.h"
 
 // Global variables
+#ifndef EXTINT_STATIC_DISPATCH
 typedef void (*voidFuncPtr)(void);
 volatile static voidFuncPtr ExtIntFunc[EXTINT_NUM_INTERRUPTS];
 
+// call the user function attached to an external interrupt, if any
+#define EXTINT_DISPATCH(intNum)	if(ExtIntFunc[intNum]) ExtIntFunc[intNum]()
+#else
+#define EXTINT_DISPATCH(intNum)
+#endif
+
 // functions
 
 //! initializes extint library
 void extintInit(void)
 {
+	#ifndef EXTINT_STATIC_DISPATCH
 	u08 intNum;
 	// detach all user functions from interrupts
 	for(intNum=0; intNum<EXTINT_NUM_INTERRUPTS; intNum++)
 		extintDetach(intNum);
+	#endif
 
 }
 
@@ -77,6 +87,7 @@ void extintConfigure(u08 interruptNum, u08 configuration)
 	// looking for clean way to do it...
 }
 
+#ifndef EXTINT_STATIC_DISPATCH
 //! Attach a user function to an external interrupt
 void extintAttach(u08 interruptNum, void (*userHandler)(void) )
 {
@@ -100,22 +111,31 @@ void extintDetach(u08 interruptNum)
 		ExtIntFunc[interruptNum] = 0;
 	}
 }
+#endif
 
 //! Interrupt handler for INT0
 EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT0)
 {
-	// if a user function is defined, execute it
-	if(ExtIntFunc[EXTINT0])
-		ExtIntFunc[EXTINT0]();
+	ISRSTAT_ENTER(ISRSTAT_INT0);
+	// run the handler bound at build time, or the attached user function
+	#ifdef EXTINT0_HANDLER
+	EXTINT0_HANDLER();
+	#else
+	EXTINT_DISPATCH(EXTINT0);
+	#endif
 }
 
 #ifdef SIG_INTERRUPT1
 //! Interrupt handler for INT1
 EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT1)
 {
-	// if a user function is defined, execute it
-	if(ExtIntFunc[EXTINT1])
-		ExtIntFunc[EXTINT1]();
+	ISRSTAT_ENTER(ISRSTAT_INT0+1);
+	// run the handler bound at build time, or the attached user function
+	#ifdef EXTINT1_HANDLER
+	EXTINT1_HANDLER();
+	#else
+	EXTINT_DISPATCH(EXTINT1);
+	#endif
 }
 #endif
 
@@ -123,9 +143,13 @@ EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT1)
 //! Interrupt handler for INT2
 EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT2)
 {
-	// if a user function is defined, execute it
-	if(ExtIntFunc[EXTINT2])
-		ExtIntFunc[EXTINT2]();
+	ISRSTAT_ENTER(ISRSTAT_INT0+2);
+	// run the handler bound at build time, or the attached user function
+	#ifdef EXTINT2_HANDLER
+	EXTINT2_HANDLER();
+	#else
+	EXTINT_DISPATCH(EXTINT2);
+	#endif
 }
 #endif
 
@@ -133,9 +157,13 @@ EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT2)
 //! Interrupt handler for INT3
 EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT3)
 {
-	// if a user function is defined, execute it
-	if(ExtIntFunc[EXTINT3])
-		ExtIntFunc[EXTINT3]();
+	ISRSTAT_ENTER(ISRSTAT_INT0+3);
+	// run the handler bound at build time, or the attached user function
+	#ifdef EXTINT3_HANDLER
+	EXTINT3_HANDLER();
+	#else
+	EXTINT_DISPATCH(EXTINT3);
+	#endif
 }
 #endif
 
@@ -143,9 +171,13 @@ EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT3)
 //! Interrupt handler for INT4
 EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT4)
 {
-	// if a user function is defined, execute it
-	if(ExtIntFunc[EXTINT4])
-		ExtIntFunc[EXTINT4]();
+	ISRSTAT_ENTER(ISRSTAT_INT0+4);
+	// run the handler bound at build time, or the attached user function
+	#ifdef EXTINT4_HANDLER
+	EXTINT4_HANDLER();
+	#else
+	EXTINT_DISPATCH(EXTINT4);
+	#endif
 }
 #endif
 
@@ -153,9 +185,13 @@ EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT4)
 //! Interrupt handler for INT5
 EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT5)
 {
-	// if a user function is defined, execute it
-	if(ExtIntFunc[EXTINT5])
-		ExtIntFunc[EXTINT5]();
+	ISRSTAT_ENTER(ISRSTAT_INT0+5);
+	// run the handler bound at build time, or the attached user function
+	#ifdef EXTINT5_HANDLER
+	EXTINT5_HANDLER();
+	#else
+	EXTINT_DISPATCH(EXTINT5);
+	#endif
 }
 #endif
 
@@ -163,9 +199,13 @@ EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT5)
 //! Interrupt handler for INT6
 EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT6)
 {
-	// if a user function is defined, execute it
-	if(ExtIntFunc[EXTINT6])
-		ExtIntFunc[EXTINT6]();
+	ISRSTAT_ENTER(ISRSTAT_INT0+6);
+	// run the handler bound at build time, or the attached user function
+	#ifdef EXTINT6_HANDLER
+	EXTINT6_HANDLER();
+	#else
+	EXTINT_DISPATCH(EXTINT6);
+	#endif
 }
 #endif
 
@@ -173,9 +213,13 @@ EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT6)
 //! Interrupt handler for INT7
 EXTINT_INTERRUPT_HANDLER(SIG_INTERRUPT7)
 {
-	// if a user function is defined, execute it
-	if(ExtIntFunc[EXTINT7])
-		ExtIntFunc[EXTINT7]();
+	ISRSTAT_ENTER(ISRSTAT_INT0+7);
+	// run the handler bound at build time, or the attached user function
+	#ifdef EXTINT7_HANDLER
+	EXTINT7_HANDLER();
+	#else
+	EXTINT_DISPATCH(EXTINT7);
+	#endif
 }
 #endif
 
@@ -96,9 +96,23 @@ void extintConfigure(u08 interruptNum, u08 configuration);
 //
 //		void myInterruptHandler(void) { ... }
 
+// Build-time binding
+//		Instead of attaching a function at run time, it can be bound to an
+//		interrupt by defining EXTINT<n>_HANDLER in your project's global.h:
+//
+//		void myInterruptHandler(void);
+//		#define EXTINT0_HANDLER		myInterruptHandler
+//
+//		The interrupt then calls it directly, without the function pointer
+//		table (and can inline it if it is visible, see timer.h).  Define
+//		EXTINT_STATIC_DISPATCH as well to remove the table and
+//		extintAttach()/extintDetach() altogether.
+
+#ifndef EXTINT_STATIC_DISPATCH
 //! Attach a user function to an external interrupt
 void extintAttach(u08 interruptNum, void (*userHandler)(void) );
 //! Detach a user function from an external interrupt
 void extintDetach(u08 interruptNum);
+#endif
 
 #endif
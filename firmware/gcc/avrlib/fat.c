@@ -27,16 +27,16 @@
 #include <avr/pgmspace.h>
 #include <string.h>
 
-#include "ata.h"
+#include "blockdev.h"
+#include "seccache.h"
 #include "rprintf.h"
 #include "debug.h"
 
 #include "fat.h"
-#include "fatconf.h"
 
 // globals
 // buffers
-unsigned char *SectorBuffer  =		(unsigned char *) FAT_SECTOR_BUFFER_ADDR;
+unsigned char *SectorBuffer;			//< sector last loaded by fatLoadSector() (in the sector cache)
 unsigned char *FileNameBuffer =		(unsigned char *) FAT_FILENAME_BUFFER_ADDR;
 unsigned char *PathNameBuffer =		(unsigned char *) FAT_PATHNAME_BUFFER_ADDR;
 
@@ -46,13 +46,39 @@ unsigned char Fat32Enabled;
 unsigned long FirstDataSector;
 unsigned short BytesPerSector;
 unsigned short SectorsPerCluster;
+static unsigned char ClusterShift;		//< log2(SectorsPerCluster)
 unsigned long FirstFATSector;
-unsigned long RootDirStartCluster;
+unsigned long RootDirStartCluster;		//< root directory cluster (0 for the FAT16 root area)
+unsigned long FirstRootDirSector;		//< start of the FAT16 root directory area
+unsigned short RootDirSectors;			//< size of the FAT16 root directory area
 
 // operating variables
+static BlockDev* FatDev;				//< device holding the mounted volume
 unsigned long CurrentDirStartCluster;	//< current directory starting cluster
 struct FileInfoStruct FileInfo;			//< file information for last file accessed
-unsigned long FatInCache = 0;
+
+// directory cursor used by fatGetDirEntry()
+static FatDir DirCursor;
+static unsigned char DirCursorValid;
+
+#ifdef FAT_WRITE
+// volume layout needed for writing
+static unsigned char NumFATs;			//< copies of the FAT
+static unsigned long SectorsPerFAT;		//< size of each copy
+static unsigned long LastCluster;		//< highest cluster number of the volume
+static unsigned long FSInfoSector;		//< FAT32 FSInfo sector (0 if none, or already updated)
+static unsigned long NextFreeCluster;	//< where the search for a free cluster starts
+#endif
+
+#ifdef FAT_DIR_INDEX
+// name hashes and cursor checkpoints for the directory at DirCursor
+static unsigned char DirHash[FAT_DIR_INDEX_SIZE];
+static FatDir DirCheckpoint[(FAT_DIR_INDEX_SIZE+FAT_DIR_INDEX_STEP-1)/FAT_DIR_INDEX_STEP];
+static unsigned short DirIndexCount;	// entries indexed so far
+#endif
+
+// local functions
+static unsigned char fatLoadSector(unsigned long sector);
 
 
 /*************************************************************************/
@@ -61,7 +87,7 @@ unsigned long FatInCache = 0;
 
 unsigned long fatClustToSect(unsigned long clust)
 {
-	return ((clust-2) * SectorsPerCluster) + FirstDataSector;
+	return ((clust-2) << ClusterShift) + FirstDataSector;
 }
 
 unsigned int fatClusterSize(void)
@@ -70,14 +96,20 @@ unsigned int fatClusterSize(void)
 	return SectorsPerCluster;
 }
 
-unsigned char fatInit( unsigned char device)
+unsigned char fatInit(BlockDev* dev)
 {
 	//struct partrecord *pr;
 	struct bpb710 *bpb;
 
+	FatDev = dev;
+
+	// forget anything cached from a previous disk
+	seccacheInvalidate(dev);
+	DirCursorValid = FALSE;
+
 	// read partition table
-	// TODO.... error checking
-	ataReadSectors(DRIVE0, 0, 1, SectorBuffer);
+	if(!fatLoadSector(0))
+		return 1;
 	// map first partition record	
 	// save partition information to global PartInfo
 	PartInfo = *((struct partrecord *) ((struct partsector *) SectorBuffer)->psPart);
@@ -85,7 +117,8 @@ unsigned char fatInit( unsigned char device)
 	
 	// Read the Partition BootSector
 	// **first sector of partition in PartInfo.prStartLBA
-	ataReadSectors( DRIVE0, PartInfo.prStartLBA, 1, SectorBuffer );
+	if(!fatLoadSector(PartInfo.prStartLBA))
+		return 1;
 	bpb = (struct bpb710 *) ((struct bootsector710 *) SectorBuffer)->bsBPB;
 
 	// setup global disk constants
@@ -101,6 +134,8 @@ unsigned char fatInit( unsigned char device)
 		FirstDataSector	+= bpb->bpbResSectors + bpb->bpbFATs * bpb->bpbBigFATsecs;
 	}
 	SectorsPerCluster	= bpb->bpbSecPerClust;
+	// (cluster sizes are powers of two)
+	for(ClusterShift=0; (1<<ClusterShift) < SectorsPerCluster; ClusterShift++);
 	BytesPerSector		= bpb->bpbBytesPerSec;
 	FirstFATSector		= bpb->bpbResSectors + PartInfo.prStartLBA;
 
@@ -109,10 +144,13 @@ unsigned char fatInit( unsigned char device)
 		case PART_TYPE_DOSFAT16:
 		case PART_TYPE_FAT16:
 		case PART_TYPE_FAT16LBA:
-			// first directory cluster is 2 by default (clusters range 2->big)
-			RootDirStartCluster = CLUST_FIRST;
+			// the root directory is a fixed area ahead of the data clusters,
+			// not a cluster chain (cluster 0 refers to it)
+			RootDirStartCluster = MSDOSFSROOT;
+			FirstRootDirSector = FirstDataSector;
+			RootDirSectors = (bpb->bpbRootDirEnts + DIRENTRIES_PER_SECTOR-1)/DIRENTRIES_PER_SECTOR;
 			// push data sector pointer to end of root directory area
-			//FirstDataSector += (bpb->bpbRootDirEnts)/DIRENTRIES_PER_SECTOR;
+			FirstDataSector += RootDirSectors;
 			Fat32Enabled = FALSE;
 			break;
 		case PART_TYPE_FAT32LBA:
@@ -129,6 +167,20 @@ unsigned char fatInit( unsigned char device)
 			break;
 	}
 
+#ifdef FAT_WRITE
+	NumFATs = bpb->bpbFATs;
+	SectorsPerFAT = bpb->bpbFATsecs ? bpb->bpbFATsecs : bpb->bpbBigFATsecs;
+	// clusters that fit in the data area, and in the FAT
+	LastCluster = (((bpb->bpbSectors ? bpb->bpbSectors : bpb->bpbHugeSectors)
+		- (FirstDataSector - PartInfo.prStartLBA)) >> ClusterShift) + 1;
+	if(LastCluster >= (SectorsPerFAT << (Fat32Enabled ? 7 : 8)))
+		LastCluster = (SectorsPerFAT << (Fat32Enabled ? 7 : 8)) - 1;
+	FSInfoSector = 0;
+	if(Fat32Enabled && bpb->bpbFSInfo)
+		FSInfoSector = PartInfo.prStartLBA + bpb->bpbFSInfo;
+	NextFreeCluster = CLUST_FIRST;
+#endif
+
 	// set current directory to root (\)
 	CurrentDirStartCluster = RootDirStartCluster;
 	PathNameBuffer[0] = '\\';
@@ -179,126 +231,255 @@ unsigned char fatInit( unsigned char device)
 
 //////////////////////////////////////////////////////////////
 
-unsigned char fatGetDirEntry(unsigned short entry)
+// point SectorBuffer at a sector, reading it into the sector cache if needed
+static unsigned char fatLoadSector(unsigned long sector)
 {
-	unsigned long sector;
-	struct direntry *de = 0;	// avoid compiler warning by initializing
-	struct winentry *we;
-	unsigned char haveLongNameEntry;
-	unsigned char gotEntry;
-	unsigned short b;
-	int i,index;
-	char *fnbPtr;
-	unsigned short entrycount = 0;
+	unsigned char* buffer;
 
-	// read dir data
-	sector = fatClustToSect(CurrentDirStartCluster);
+	if(!(buffer = seccacheRead(FatDev, sector)))
+		return FALSE;
+	SectorBuffer = buffer;
+	return TRUE;
+}
+
+void fatDirOpen(FatDir* dir, unsigned long cluster)
+{
+	dir->startCluster = cluster;
+	dir->cluster = cluster;
+	dir->entry = 0;
+	dir->index = 0;
+	if(cluster)
+	{
+		dir->sector = fatClustToSect(cluster);
+		dir->sectorsLeft = SectorsPerCluster-1;
+	}
+	else
+	{
+		// FAT16 root directory: a fixed area ahead of the data clusters
+		dir->sector = FirstRootDirSector;
+		dir->sectorsLeft = RootDirSectors-1;
+	}
+}
 
-	haveLongNameEntry = 0;
-	gotEntry = 0;
+// return the directory slot at the cursor, moving on to the next sector
+// or cluster of the directory as needed (0 at the end of the directory)
+static struct direntry* fatDirSlot(FatDir* dir)
+{
+	unsigned long next;
 
-	index = 16;	// crank it up
-	
-	//while(entrycount < entry) 
-	while(1)
+	if(dir->index == DIRENTRIES_PER_SECTOR)
 	{
-		if(index == 16)	// time for next sector ?
+		if(dir->sectorsLeft)
+		{
+			// next sector of this cluster
+			dir->sectorsLeft--;
+			dir->sector++;
+		}
+		else
 		{
-			ataReadSectors( DRIVE0, sector++, 1, SectorBuffer);
-			de = (struct direntry *) SectorBuffer;
-			index = 0;
+			// follow the cluster chain (the FAT16 root area has none)
+			if(!dir->cluster)
+				return 0;
+			next = fatNextCluster(dir->cluster);
+			if(!next)
+				return 0;
+			dir->cluster = next;
+			dir->sector = fatClustToSect(next);
+			dir->sectorsLeft = SectorsPerCluster-1;
 		}
-		
+		dir->index = 0;
+	}
+	if(!fatLoadSector(dir->sector))
+		return 0;
+	return ((struct direntry *) SectorBuffer) + dir->index;
+}
+
+unsigned char fatDirNext(FatDir* dir)
+{
+	struct direntry *de;
+	struct winentry *we;
+	unsigned char haveLongNameEntry = 0;
+	unsigned short b;
+	int i;
+	unsigned char *fnbPtr;
+
+	while( (de = fatDirSlot(dir)) )
+	{
 		// check the status of this directory entry slot
 		if(de->deName[0] == 0x00)
 		{
 			// slot is empty and this is the end of directory
-			gotEntry = 0;
-			break;
+			// (leave the cursor here)
+			return FALSE;
 		}
-		else if(de->deName[0] == 0xE5)
+		dir->index++;
+
+		if(de->deName[0] == 0xE5)
+		{
+			// this is an empty slot, any long name collected is orphaned
+			haveLongNameEntry = 0;
+		}
+		else if(de->deAttributes == ATTR_LONG_FILENAME)
 		{
-			// this is an empty slot
-			// do nothing and move to the next one
+			// we have a long name entry
+			// cast this directory entry as a "windows" (LFN: LongFileName) entry
+			we = (struct winentry *) de;
+
+			b = WIN_ENTRY_CHARS*( (we->weCnt-1) & 0x0f);		// index into string
+			fnbPtr = &FileNameBuffer[b];
+			for (i=0;i<5;i++)	*fnbPtr++ = we->wePart1[i*2];	// copy first part
+			for (i=0;i<6;i++)	*fnbPtr++ = we->wePart2[i*2];	// second part
+			for (i=0;i<2;i++)	*fnbPtr++ = we->wePart3[i*2];	// and third part
+			if (we->weCnt & WIN_LAST) *fnbPtr = 0;				// in case dirnamelength is multiple of 13, add termination
+			if ((we->weCnt & 0x0f) == 1) haveLongNameEntry = 1;	// flag that we have a complete long name entry set
 		}
 		else
 		{
-			// this is a valid and occupied entry
-			// is it a part of a long file/dir name?
-			if(de->deAttributes == ATTR_LONG_FILENAME)
+			// we have a short name entry
+			// if it has no multi-part long name ahead of it,
+			// use the short (8.3 format) name, without the padding
+			if(!haveLongNameEntry)
 			{
-				// we have a long name entry
-				// cast this directory entry as a "windows" (LFN: LongFileName) entry
-				we = (struct winentry *) de;
-				
-				b = WIN_ENTRY_CHARS*( (we->weCnt-1) & 0x0f);		// index into string
-				fnbPtr = &FileNameBuffer[b];
-				for (i=0;i<5;i++)	*fnbPtr++ = we->wePart1[i*2];	// copy first part
-				for (i=0;i<6;i++)	*fnbPtr++ = we->wePart2[i*2];	// second part
-				for (i=0;i<2;i++)	*fnbPtr++ = we->wePart3[i*2];	// and third part
-				if (we->weCnt & WIN_LAST) *fnbPtr = 0;				// in case dirnamelength is multiple of 13, add termination
-				if ((we->weCnt & 0x0f) == 1) haveLongNameEntry = 1;	// flag that we have a complete long name entry set
-			}
-			else
-			{
-				// we have a short name entry
-				
-				// check if this is the short name entry corresponding
-				// to the end of a multi-part long name entry
-				if(haveLongNameEntry)
-				{
-					// a long entry name has been collected
-					if(entrycount == entry)		
-					{
-						// desired entry has been found, break out
-						gotEntry = 1;
-						break;
-					}
-					// otherwise
-					haveLongNameEntry = 0;	// clear long name flag
-					entrycount++;			// increment entry counter		
-				}
-				else
+				fnbPtr = FileNameBuffer;
+				for (i=0; (i<8) && (de->deName[i] != ' '); i++)
+					*fnbPtr++ = de->deName[i];						// copy name
+				if(de->deExtension[0] != ' ')
 				{
-					// entry is a short name (8.3 format) without a
-					// corresponding multi-part long name entry
-					fnbPtr = FileNameBuffer;
-					for (i=0;i<8;i++)	*fnbPtr++ = de->deName[i];		// copy name
-					*fnbPtr++ = '.';									// insert '.'
-					for (i=0;i<3;i++)	*fnbPtr++ = de->deExtension[i];	// copy extension
-					*fnbPtr = 0;										// null-terminate
-
-					if(entrycount == entry)		
-					{
-						// desired entry has been found, break out
-						gotEntry = 1;
-						break;
-					}
-					// otherwise
-					entrycount++;			// increment entry counter		
+					*fnbPtr++ = '.';								// insert '.'
+					for (i=0; (i<3) && (de->deExtension[i] != ' '); i++)
+						*fnbPtr++ = de->deExtension[i];				// copy extension
 				}
+				*fnbPtr = 0;										// null-terminate
 			}
+
+			// store file/dir starting cluster (start of data)
+			FileInfo.StartCluster = (unsigned long) ((unsigned long)de->deHighClust << 16) + de->deStartCluster;
+			// store file/dir size
+			// (note: size field for subdirectory entries is always zero)
+			FileInfo.Size = de->deFileSize;
+			// store file/dir attributes
+			FileInfo.Attr = de->deAttributes;
+			// store file/dir creation time
+			FileInfo.CreateTime = de->deCTime[0] | de->deCTime[1]<<8;
+			// store file/dir creation date
+			FileInfo.CreateDate = de->deCDate[0] | de->deCDate[1]<<8;
+
+			dir->entry++;
+			return TRUE;
 		}
-		// next directory entry
-		de++;
-		// next index
-		index++;
 	}
-	
-	// we have a file/dir to return
-	// store file/dir starting cluster (start of data)
-	FileInfo.StartCluster = (unsigned long) ((unsigned long)de->deHighClust << 16) + de->deStartCluster;
-	// store file/dir size
-	// (note: size field for subdirectory entries is always zero)
-	FileInfo.Size = de->deFileSize;
-	// store file/dir attributes
-	FileInfo.Attr = de->deAttributes;
-	// store file/dir creation time
-	FileInfo.CreateTime = de->deCTime[0] | de->deCTime[1]<<8;
-	// store file/dir creation date
-	FileInfo.CreateTime = de->deCDate[0] | de->deCDate[1]<<8;
-
-	return gotEntry;
+	return FALSE;
+}
+
+#ifdef FAT_DIR_INDEX
+// case-insensitive 8-bit hash of a name
+static unsigned char fatNameHash(unsigned char* name)
+{
+	unsigned char h = 0;
+	unsigned char c;
+	while( (c = *name++) )
+	{
+		if((c >= 'a') && (c <= 'z'))
+			c -= 'a'-'A';
+		h = ((h << 1) | (h >> 7)) ^ c;
+	}
+	return h;
+}
+#endif
+
+// read the entry at DirCursor, adding it to the index on the first scan
+static unsigned char fatDirStep(void)
+{
+#ifdef FAT_DIR_INDEX
+	unsigned short n = DirCursor.entry;
+
+	// remember where every FAT_DIR_INDEX_STEP'th entry starts
+	if((n == DirIndexCount) && (n < FAT_DIR_INDEX_SIZE) && !(n % FAT_DIR_INDEX_STEP))
+		DirCheckpoint[n / FAT_DIR_INDEX_STEP] = DirCursor;
+	if(!fatDirNext(&DirCursor))
+		return FALSE;
+	if((n == DirIndexCount) && (n < FAT_DIR_INDEX_SIZE))
+	{
+		DirHash[n] = fatNameHash(FileNameBuffer);
+		DirIndexCount++;
+	}
+	return TRUE;
+#else
+	return fatDirNext(&DirCursor);
+#endif
+}
+
+// position DirCursor so that the next fatDirStep() reads entry number "entry"
+// (or as close ahead of it as possible)
+static void fatDirSeek(unsigned short entry)
+{
+#ifdef FAT_DIR_INDEX
+	unsigned short k;
+#endif
+
+	if(!DirCursorValid || (DirCursor.startCluster != CurrentDirStartCluster))
+	{
+		// new directory, start over
+		fatDirOpen(&DirCursor, CurrentDirStartCluster);
+		DirCursorValid = TRUE;
+#ifdef FAT_DIR_INDEX
+		DirIndexCount = 0;
+#endif
+	}
+#ifdef FAT_DIR_INDEX
+	// jump to the nearest recorded position at or before the entry,
+	// if that is closer than where the cursor is
+	if(DirIndexCount)
+	{
+		k = entry;
+		if(k >= DirIndexCount)
+			k = DirIndexCount-1;
+		k /= FAT_DIR_INDEX_STEP;
+		if((entry < DirCursor.entry) || (DirCheckpoint[k].entry > DirCursor.entry))
+		{
+			DirCursor = DirCheckpoint[k];
+			return;
+		}
+	}
+#endif
+	if(entry < DirCursor.entry)
+		fatDirOpen(&DirCursor, CurrentDirStartCluster);
+}
+
+unsigned char fatGetDirEntry(unsigned short entry)
+{
+	fatDirSeek(entry);
+	// walk forward to the entry
+	while(DirCursor.entry <= entry)
+	{
+		if(!fatDirStep())
+			return FALSE;
+	}
+	return TRUE;
+}
+
+int fatFindEntry(char* name)
+{
+	unsigned short entry = 0;
+#ifdef FAT_DIR_INDEX
+	unsigned char h = fatNameHash((unsigned char*)name);
+
+	// check the entries already indexed first
+	fatDirSeek(0);
+	for(entry=0; entry<DirIndexCount; entry++)
+	{
+		if((DirHash[entry] == h) && fatGetDirEntry(entry) && !strcasecmp((char*)FileNameBuffer, name))
+			return entry;
+	}
+#endif
+	// scan the rest of the directory
+	while(fatGetDirEntry(entry))
+	{
+		if(!strcasecmp((char*)FileNameBuffer, name))
+			return entry;
+		entry++;
+	}
+	return -1;
 }
 
 // change directory into 
@@ -326,8 +507,8 @@ unsigned char fatChangeDirectory(unsigned short entry)
 			}
 			// TODO: handle pathname properly for going up a directory
 			// set path string
-			strcat(PathNameBuffer, FileNameBuffer);
-			strcat(PathNameBuffer, "\\");
+			strcat((char*)PathNameBuffer, (char*)FileNameBuffer);
+			strcat((char*)PathNameBuffer, "\\");
 			// return success
 			return TRUE;
 		}
@@ -377,7 +558,7 @@ void fatPrintDirEntry(void)
 	rprintfChar(' ');
 
 	// print filename
-	rprintfStr(FileNameBuffer);
+	rprintfStr((char*)FileNameBuffer);
 }
 
 void fatDumpDirSlot(unsigned short slot)
@@ -404,28 +585,27 @@ unsigned long fatGetFilesize(void)
 // return the long name of the last directory entry
 char* fatGetFilename(void)
 {	
-	return FileNameBuffer;
+	return (char*)FileNameBuffer;
 }
 
 // return the directory of the last directory entry
 char* fatGetDirname(void)
 {	
-	return PathNameBuffer;
+	return (char*)PathNameBuffer;
 }
 
 // load a clusterfull of data
 void fatLoadCluster(unsigned long cluster, unsigned char *buffer)
 {
-	register unsigned char i;
-	// read cluster
-	//while ( ataReadSectors( DRIVE0, clust2sect(cluster), SectorsPerCluster, buffer) != 0);
-	for(i=0; i<SectorsPerCluster; i++)
-	{
-		ataReadSectors( DRIVE0, fatClustToSect(cluster)+i, 1, buffer+(i<<9) );
-		// temporary fix for wierd misaligned cluster problem
-		// (only when using FAT16?)
-//		ataReadSectors( DRIVE0, fatClustToSect(cluster+8)+i, 1, buffer+(i<<9) );
-	}
+	// read cluster, in one multi-sector transfer
+	blockdevRead(FatDev, fatClustToSect(cluster), SectorsPerCluster, buffer);
+}
+
+unsigned char fatLoadSectors(unsigned long cluster, unsigned char first, unsigned char count, unsigned char *buffer)
+{
+	if((unsigned short)first + count > SectorsPerCluster)
+		return FALSE;
+	return !blockdevRead(FatDev, fatClustToSect(cluster) + first, count, buffer);
 }
 
 
@@ -435,8 +615,7 @@ unsigned long fatNextCluster(unsigned long cluster)
 	unsigned long nextCluster;
 	unsigned long fatMask;
 	unsigned long fatOffset;
-	unsigned long sector;
-	unsigned int offset;
+	unsigned char* fatSector;
 	
 	// get fat offset in bytes
 	if(Fat32Enabled)
@@ -454,24 +633,18 @@ unsigned long fatNextCluster(unsigned long cluster)
 		fatMask = FAT16_MASK;
 	}
 	
-	// calculate the FAT sector that we're interested in
-	sector = FirstFATSector + (fatOffset / BytesPerSector);
-	// calculate offset of the our entry within that FAT sector
-	offset = fatOffset % BytesPerSector;
-
-	// if we don't already have this FAT chunk loaded, go get it
-	if (sector != FatInCache)
-	{
-		// read sector of FAT table
-		while (ataReadSectors( DRIVE0, sector, 1, (unsigned char*)FAT_CACHE_ADDR) != 0);
-		FatInCache = sector;
-	}
+	// get the FAT sector that we're interested in (512-byte sectors)
+	fatSector = seccacheRead(FatDev, FirstFATSector + (fatOffset >> 9));
+	// treat an unreadable FAT as the end of the chain
+	if(!fatSector)
+		return 0;
 
-	// read the nextCluster value
-	nextCluster = (*((unsigned long*) &((char*)FAT_CACHE_ADDR)[offset])) & fatMask;
+	// read the nextCluster value at the offset of our entry
+	nextCluster = (*((DWORD*) &fatSector[fatOffset & 0x1FF])) & fatMask;
 
 	// check to see if we're at the end of the chain
-	if (nextCluster == (CLUST_EOFE & fatMask))
+	// (any value in the end-of-chain range marks it)
+	if (nextCluster >= (CLUST_EOFS & fatMask))
 		nextCluster = 0;
 
 #ifdef DEBUG_FAT
@@ -482,3 +655,448 @@ unsigned long fatNextCluster(unsigned long cluster)
 	
 	return nextCluster;
 }
+
+void fatFileOpen(FatFile* file, unsigned long startCluster, unsigned long size)
+{
+	file->startCluster = startCluster;
+	file->size = size;
+	// the first run starts at the first cluster
+	file->numExtents = 0;
+	if(startCluster)
+	{
+		file->extents[0].start = startCluster;
+		file->extents[0].length = 1;
+		file->numExtents = 1;
+	}
+	file->tailIndex = 0;
+	file->tailCluster = startCluster;
+}
+
+unsigned long fatFileCluster(FatFile* file, unsigned long index)
+{
+	FatExtent* ext = file->extents;
+	unsigned long base = 0;
+	unsigned long n;
+	unsigned long cluster;
+	unsigned long next;
+	unsigned char i;
+	unsigned char found = TRUE;
+
+	if(!file->numExtents)
+		return 0;
+
+	// look in the cached runs
+	for(i=0; i<file->numExtents; i++, ext++)
+	{
+		if(index - base < ext->length)
+			return ext->start + (index - base);
+		base += ext->length;
+	}
+	ext--;
+
+	// not cached: walk the chain on from the furthest position known,
+	// or from the end of the cached runs if that is past the index
+	if(index >= file->tailIndex)
+	{
+		n = file->tailIndex;
+		cluster = file->tailCluster;
+	}
+	else
+	{
+		n = base-1;
+		cluster = ext->start + ext->length-1;
+	}
+	while(n < index)
+	{
+		next = fatNextCluster(cluster);
+		if(!next)
+		{
+			// end of the chain: keep how far it got, so that later lookups
+			// past the end do not walk the chain again
+			found = FALSE;
+			break;
+		}
+		n++;
+		// add clusters that follow the cached runs to them,
+		// while there is room
+		if(n == base)
+		{
+			if((next == cluster+1) && (ext->length != 0xFFFF))
+			{
+				ext->length++;
+				base++;
+			}
+			else if(file->numExtents < FAT_FILE_EXTENTS)
+			{
+				ext++;
+				ext->start = next;
+				ext->length = 1;
+				file->numExtents++;
+				base++;
+			}
+		}
+		cluster = next;
+	}
+	if(n > file->tailIndex)
+	{
+		file->tailIndex = n;
+		file->tailCluster = cluster;
+	}
+	return found ? cluster : 0;
+}
+
+unsigned long fatFileSector(FatFile* file, unsigned long index)
+{
+	unsigned long cluster;
+
+	cluster = fatFileCluster(file, index >> ClusterShift);
+	if(!cluster)
+		return 0;
+	return fatClustToSect(cluster) + (index & (SectorsPerCluster-1));
+}
+
+unsigned short fatFileReadSectors(FatFile* file, unsigned long index, unsigned short count, unsigned char* buffer)
+{
+	unsigned long sector;
+	unsigned long runStart = 0;
+	unsigned short run = 0;
+	unsigned short done = 0;
+
+	// collect sectors into runs that are consecutive on the disk, and
+	// read each run with one transfer
+	while(done + run < count)
+	{
+		sector = fatFileSector(file, index + done + run);
+		if(run && (sector == runStart + run))
+		{
+			run++;
+			continue;
+		}
+		if(run)
+		{
+			if(blockdevRead(FatDev, runStart, run, buffer))
+				return done;
+			buffer += run << 9;
+			done += run;
+		}
+		// (the end of the file ends the read)
+		if(!sector)
+			return done;
+		runStart = sector;
+		run = 1;
+	}
+	if(run && !blockdevRead(FatDev, runStart, run, buffer))
+		done += run;
+	return done;
+}
+
+#ifdef FAT_WRITE
+// read the FAT entry of a cluster (CLUST_BAD if the FAT cannot be read)
+static unsigned long fatGetEntry(unsigned long cluster)
+{
+	unsigned long offset = Fat32Enabled ? (cluster << 2) : (cluster << 1);
+	unsigned char* sector;
+
+	if(!(sector = seccacheRead(FatDev, FirstFATSector + (offset >> 9))))
+		return CLUST_BAD;
+	if(Fat32Enabled)
+		return *((DWORD*) &sector[offset & 0x1FF]) & FAT32_MASK;
+	return *((WORD*) &sector[offset & 0x1FF]);
+}
+
+// set the FAT entry of a cluster in one copy of the FAT (in the cache)
+static unsigned char fatSetEntry(unsigned char copy, unsigned long cluster, unsigned long value)
+{
+	unsigned long offset = Fat32Enabled ? (cluster << 2) : (cluster << 1);
+	unsigned char* sector;
+	DWORD* entry;
+
+	if(!(sector = seccacheRead(FatDev, FirstFATSector + copy*SectorsPerFAT + (offset >> 9))))
+		return FALSE;
+	if(Fat32Enabled)
+	{
+		// (the top four bits are reserved)
+		entry = (DWORD*) &sector[offset & 0x1FF];
+		*entry = (*entry & ~FAT32_MASK) | (value & FAT32_MASK);
+	}
+	else
+		*((WORD*) &sector[offset & 0x1FF]) = value;
+	seccacheMarkDirty(sector);
+	return TRUE;
+}
+
+// mark the FAT32 free cluster count unknown, since it is not maintained
+// (once per mount)
+static void fatInvalidateFSInfo(void)
+{
+	struct fsinfo* fsi;
+
+	if(FSInfoSector && (fsi = (struct fsinfo*) seccacheRead(FatDev, FSInfoSector)))
+	{
+		if(!memcmp(fsi->fsisig1, "RRaA", 4) && !memcmp(fsi->fsisig2, "rrAa", 4) &&
+			(*((DWORD*) fsi->fsinfree) != 0xFFFFFFFF))
+		{
+			*((DWORD*) fsi->fsinfree) = 0xFFFFFFFF;
+			seccacheMarkDirty((unsigned char*) fsi);
+		}
+	}
+	FSInfoSector = 0;
+}
+
+// find a free cluster, starting at the next-free hint and skipping the
+// clusters the writer holds but has not yet recorded in the FAT
+// (returns 0 if the volume is full)
+static unsigned long fatFindFree(FatWriter* w)
+{
+	unsigned long cluster = NextFreeCluster;
+	unsigned long n;
+	unsigned char i;
+
+	for(n = LastCluster-1; n; n--, cluster++)
+	{
+		if((cluster < CLUST_FIRST) || (cluster > LastCluster))
+			cluster = CLUST_FIRST;
+		if(fatGetEntry(cluster) != CLUST_FREE)
+			continue;
+		for(i=0; (i < w->numPending) && (w->pending[i] != cluster); i++);
+		if(i == w->numPending)
+		{
+			NextFreeCluster = cluster+1;
+			return cluster;
+		}
+	}
+	return 0;
+}
+
+// convert a name to the blank-padded 8.3 form of a directory entry
+// (returns FALSE if it does not fit)
+static unsigned char fatShortName(char* name, unsigned char* shortName)
+{
+	unsigned char i = 0;
+	unsigned char end = 8;
+	char c;
+
+	memset(shortName, ' ', 11);
+	while( (c = *name++) )
+	{
+		if(c == '.')
+		{
+			// one dot, after the base name
+			if(!i || (end == 11))
+				return FALSE;
+			i = 8;
+			end = 11;
+			continue;
+		}
+		if(i == end)
+			return FALSE;
+		if((c >= 'a') && (c <= 'z'))
+			c -= 'a'-'A';
+		else if((c <= ' ') || strchr("\"*+,/:;<=>?[\\]|", c))
+			return FALSE;
+		shortName[i++] = c;
+	}
+	return i != 0;
+}
+
+// end a chain at a cluster, freeing the clusters after it
+static unsigned char fatTrimChain(unsigned long cluster)
+{
+	unsigned long next, after;
+	unsigned char copy;
+
+	if(!(next = fatNextCluster(cluster)))
+		return TRUE;
+	fatInvalidateFSInfo();
+	// cut the chain first, so that an interruption leaves only lost clusters
+	for(copy=0; copy<NumFATs; copy++)
+	{
+		if(!fatSetEntry(copy, cluster, CLUST_EOFE) || seccacheSync(FatDev))
+			return FALSE;
+	}
+	while(next)
+	{
+		after = fatNextCluster(next);
+		for(copy=0; copy<NumFATs; copy++)
+		{
+			if(!fatSetEntry(copy, next, CLUST_FREE))
+				return FALSE;
+		}
+		next = after;
+	}
+	return !seccacheSync(FatDev);
+}
+
+unsigned char fatWriteOpen(FatWriter* w, char* name)
+{
+	FatDir dir;
+	struct direntry* de;
+	unsigned char shortName[11];
+	unsigned long n;
+
+	if(fatFindEntry(name) >= 0)
+	{
+		// existing file: the cursor has just passed its entry
+		if(FileInfo.Attr & (ATTR_DIRECTORY | ATTR_VOLUME | ATTR_READONLY))
+			return FALSE;
+		w->dirSector = DirCursor.sector;
+		w->dirIndex = DirCursor.index-1;
+		w->startCluster = FileInfo.StartCluster;
+		w->size = FileInfo.Size;
+		// a size with no chain behind it is damaged too
+		if(!w->startCluster && w->size)
+			return FALSE;
+		// find the cluster holding the end of the file; an interrupted
+		// fatWriteSync() can leave the chain longer than the file, and the
+		// clusters past the end are freed so that appends follow the size
+		w->lastCluster = w->startCluster;
+		if(w->lastCluster)
+		{
+			for(n = w->size ? (w->size-1) >> (ClusterShift+9) : 0; n; n--)
+			{
+				// (a chain shorter than the file is damaged)
+				if(!(w->lastCluster = fatNextCluster(w->lastCluster)))
+					return FALSE;
+			}
+			if(!fatTrimChain(w->lastCluster))
+				return FALSE;
+		}
+	}
+	else
+	{
+		if(!fatShortName(name, shortName))
+			return FALSE;
+		// take the first free slot of the current directory
+		// (a full directory is not extended)
+		fatDirOpen(&dir, CurrentDirStartCluster);
+		while( (de = fatDirSlot(&dir)) && (de->deName[0] != SLOT_EMPTY) && (de->deName[0] != SLOT_DELETED) )
+			dir.index++;
+		if(!de)
+			return FALSE;
+		// an empty file has no clusters
+		memset(de, 0, sizeof(struct direntry));
+		memcpy(de->deName, shortName, 11);
+		de->deAttributes = ATTR_ARCHIVE;
+		// dated 1/1/1980, as there is no clock
+		de->deCDate[0] = de->deMDate[0] = (1<<DD_MONTH_SHIFT) | (1<<DD_DAY_SHIFT);
+		seccacheMarkDirty(SectorBuffer);
+		if(seccacheSync(FatDev))
+			return FALSE;
+		w->dirSector = dir.sector;
+		w->dirIndex = dir.index;
+		w->startCluster = 0;
+		w->lastCluster = 0;
+		w->size = 0;
+		// the directory has changed under the cursor and its index
+		DirCursorValid = FALSE;
+	}
+	w->syncedSize = w->size;
+	w->numPending = 0;
+	return TRUE;
+}
+
+unsigned short fatWrite(FatWriter* w, unsigned char* data, unsigned short length)
+{
+	unsigned long clusterMask = ((unsigned long)SectorsPerCluster << 9) - 1;
+	unsigned long cluster;
+	unsigned short done = 0;
+	unsigned short offset;
+	unsigned short n;
+	unsigned char* buffer;
+
+	while(done < length)
+	{
+		cluster = w->numPending ? w->pending[w->numPending-1] : w->lastCluster;
+		if(!(w->size & clusterMask) && (w->size || !cluster))
+		{
+			// the last cluster is full: take a free one, recording the
+			// ones taken so far if there is no room to hold another
+			if((w->numPending == FAT_WRITE_PENDING) && !fatWriteSync(w))
+				break;
+			if(!(cluster = fatFindFree(w)))
+				break;
+			w->pending[w->numPending++] = cluster;
+		}
+		// add to the sector at the end of the file, in the cache
+		// (a new sector is not read first)
+		offset = w->size & 0x1FF;
+		if(offset)
+			buffer = seccacheRead(FatDev, fatClustToSect(cluster) + ((w->size & clusterMask) >> 9));
+		else if( (buffer = seccacheGetNew(FatDev, fatClustToSect(cluster) + ((w->size & clusterMask) >> 9))) )
+			memset(buffer, 0, 0x200);
+		if(!buffer)
+			break;
+		n = 0x200 - offset;
+		if(n > length - done)
+			n = length - done;
+		memcpy(buffer + offset, data + done, n);
+		seccacheMarkDirty(buffer);
+		w->size += n;
+		done += n;
+		// write a sector out once it is full
+		if((offset + n == 0x200) && seccacheFlush(buffer))
+			break;
+	}
+	return done;
+}
+
+unsigned char fatWriteSync(FatWriter* w)
+{
+	unsigned char copy;
+	unsigned char i;
+	unsigned char* sector;
+	struct direntry* de;
+
+	// the data goes first, so nothing on the disk ever refers to data
+	// that has not been written
+	if(seccacheSync(FatDev))
+		return FALSE;
+
+	if(w->numPending)
+	{
+		fatInvalidateFSInfo();
+		// chain the new clusters together in every FAT copy; until they are
+		// linked to the file they are only lost clusters
+		for(copy=0; copy<NumFATs; copy++)
+		{
+			for(i=0; i<w->numPending; i++)
+			{
+				if(!fatSetEntry(copy, w->pending[i], (i+1 < w->numPending) ? w->pending[i+1] : CLUST_EOFE))
+					return FALSE;
+			}
+			if(seccacheSync(FatDev))
+				return FALSE;
+		}
+		// link them to the end of the file; until the size is updated
+		// the chain is only longer than the file (fatWriteOpen() trims it)
+		if(w->lastCluster)
+		{
+			for(copy=0; copy<NumFATs; copy++)
+			{
+				if(!fatSetEntry(copy, w->lastCluster, w->pending[0]) || seccacheSync(FatDev))
+					return FALSE;
+			}
+		}
+		else
+			w->startCluster = w->pending[0];
+		w->lastCluster = w->pending[w->numPending-1];
+		w->numPending = 0;
+	}
+
+	// finally the directory entry, in a single sector write
+	if(w->size != w->syncedSize)
+	{
+		if(!(sector = seccacheRead(FatDev, w->dirSector)))
+			return FALSE;
+		de = ((struct direntry*) sector) + w->dirIndex;
+		de->deStartCluster = w->startCluster;
+		de->deHighClust = w->startCluster >> 16;
+		de->deFileSize = w->size;
+		seccacheMarkDirty(sector);
+		if(seccacheSync(FatDev))
+			return FALSE;
+		w->syncedSize = w->size;
+	}
+	return TRUE;
+}
+#endif
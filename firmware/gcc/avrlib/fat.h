@@ -20,7 +20,8 @@
 /// \par Overview
 ///		This FAT16/32 interface allows you to detect and mount FAT16/32
 ///		partitions, browse directories and files, and read file data.
-///		The interface is designed to operate with the avrlib IDE/ATA driver.
+///		The interface reads the disk through a block device (see blockdev.h),
+///		so it runs on the IDE/ATA driver, an MMC/SD card or a serial flash.
 ///		Reading FAT efficiently requires at least 512+ bytes of RAM so this
 ///		interface may not be suitable for processors with less than 1K of RAM.
 ///		This interface will properly follow a file's cluster chain so files
@@ -38,6 +39,14 @@
 #define FAT_H
 
 #include "global.h"
+#include "blockdev.h"
+
+// include project-dependent configuration options
+#include "fatconf.h"
+
+#ifndef FAT_FILE_EXTENTS
+#define FAT_FILE_EXTENTS	4		///< number of cluster runs cached per open file
+#endif
 
 
 // Some useful cluster numbers
@@ -387,10 +396,79 @@ struct FileInfoStruct
 	unsigned short CreateDate;			//< file creation date for last file accessed
 };
 
+//! Directory cursor.
+/// Holds the position of a directory listing, so that it can be read in a
+/// single pass that follows the directory's cluster chain.
+typedef struct
+{
+	unsigned long startCluster;			//< first cluster of the directory (0 = FAT16 root)
+	unsigned long cluster;				//< cluster being read
+	unsigned long sector;				//< sector being read
+	unsigned short sectorsLeft;			//< sectors left in this cluster after this one
+	unsigned char index;				//< next slot within the sector
+	unsigned short entry;				//< number of the next entry
+} FatDir;
+
+//! A run of consecutive clusters.
+typedef struct
+{
+	unsigned long start;				//< first cluster of the run
+	unsigned short length;				//< number of clusters
+} FatExtent;
+
+//! Open file.
+/// Caches the file's cluster chain as runs of consecutive clusters, so that
+/// finding the cluster at a file position needs no FAT access once that
+/// part of the chain has been decoded.  The first FAT_FILE_EXTENTS runs are
+/// kept; beyond them only the furthest position reached is remembered.
+typedef struct
+{
+	unsigned long startCluster;			//< first cluster of the file
+	unsigned long size;					//< file size in bytes
+	unsigned long tailIndex;			//< furthest cluster index decoded
+	unsigned long tailCluster;			//< cluster at tailIndex
+	unsigned char numExtents;			//< runs in use
+	FatExtent extents[FAT_FILE_EXTENTS];	//< cached runs, in file order
+} FatFile;
+
+#ifdef FAT_WRITE
+#ifndef FAT_WRITE_PENDING
+#define FAT_WRITE_PENDING	4		///< clusters a writer may take between FAT updates
+#endif
+
+//! File open for appending.
+typedef struct
+{
+	unsigned long dirSector;			//< sector holding the file's directory entry
+	unsigned char dirIndex;				//< slot of the entry in that sector
+	unsigned long startCluster;			//< first cluster (0 while the file has none)
+	unsigned long lastCluster;			//< last cluster recorded in the FAT (0 if none)
+	unsigned long size;					//< file size in bytes, including unsynced data
+	unsigned long syncedSize;			//< size recorded in the directory entry
+	unsigned char numPending;			//< clusters taken since the last FAT update
+	unsigned long pending[FAT_WRITE_PENDING];	//< those clusters, in file order
+} FatWriter;
+#endif
+
 // Prototypes
-unsigned char fatInit( unsigned char device);
+//! Mounts the first partition of the given block device.
+/// The device stays in use until the next fatInit(); one volume is mounted at a time.
+unsigned char fatInit(BlockDev* dev);
 unsigned int fatClusterSize(void);
+//! Loads directory entry number "entry" of the current directory into the
+/// file info and filename buffer.  Returns TRUE if the entry exists.
+/// Consecutive entries are read by continuing from the previous one, so
+/// listing a directory in order costs one pass over it.
 unsigned char fatGetDirEntry(unsigned short entry);
+//! Looks up a name (case-insensitive) in the current directory and loads
+/// its entry.  Returns the entry number, or -1 if there is no such name.
+int fatFindEntry(char* name);
+//! Opens a directory cursor at the first entry of the directory starting
+/// at "cluster" (use 0 for the FAT16 root directory).
+void fatDirOpen(FatDir* dir, unsigned long cluster);
+//! Loads the entry at the cursor into the file info and filename buffer
+/// and advances the cursor.  Returns FALSE at the end of the directory.
+unsigned char fatDirNext(FatDir* dir);
 unsigned char fatChangeDirectory(unsigned short entry);
 void fatPrintDirEntry(void);
 void fatDumpDirSlot(unsigned short entry);
@@ -398,7 +476,46 @@ struct FileInfoStruct* fatGetFileInfo(void);
 unsigned long fatGetFilesize(void);
 char* fatGetFilename(void);
 char* fatGetDirname(void);
+//! Reads a whole cluster into buffer, with one multi-sector transfer.
 void fatLoadCluster(unsigned long cluster, unsigned char *buffer);
+//! Reads count sectors of a cluster, starting at sector "first" of it,
+/// into buffer.  Returns TRUE if successful.
+unsigned char fatLoadSectors(unsigned long cluster, unsigned char first, unsigned char count, unsigned char *buffer);
 unsigned long fatNextCluster(unsigned long cluster);
 
+//! Opens a file, e.g. \c fatFileOpen(&file, fatGetFileInfo()->StartCluster, fatGetFilesize());
+void fatFileOpen(FatFile* file, unsigned long startCluster, unsigned long size);
+//! Returns the cluster holding cluster number "index" of the file
+/// (0 if the file has no such cluster).
+unsigned long fatFileCluster(FatFile* file, unsigned long index);
+//! Returns the disk sector holding sector number "index" of the file
+/// (0 if the file has no such sector).
+unsigned long fatFileSector(FatFile* file, unsigned long index);
+//! Reads count sectors of the file, starting at sector number "index",
+/// straight into buffer.  Sectors that follow each other on the disk,
+/// within a cluster or across consecutive clusters, are read with one
+/// transfer.  Returns the number of sectors read, which is short at the
+/// end of the file's cluster chain or on a read error.
+/// \note Reads bypass the sector cache: sync a file being written first.
+unsigned short fatFileReadSectors(FatFile* file, unsigned long index, unsigned short count, unsigned char* buffer);
+
+#ifdef FAT_WRITE
+//! Opens a file in the current directory for appending, creating it
+/// (with an 8.3 name) if it does not exist.  Returns TRUE if successful.
+/// A new file needs a free slot in the directory, which is not extended.
+unsigned char fatWriteOpen(FatWriter* w, char* name);
+//! Appends data to the file.  Sectors are written as they fill; the
+/// rest stays in the sector cache until fatWriteSync().  Returns the
+/// number of bytes written, which is short if the volume is full or a
+/// write fails.
+unsigned short fatWrite(FatWriter* w, unsigned char* data, unsigned short length);
+//! Writes out the file's data, then its clusters to every FAT copy, then
+/// its size to the directory entry.  A power cut before this completes
+/// loses only the data since the previous sync; at worst it leaves lost
+/// clusters or a chain longer than the file, which a disk check repairs.
+/// Also called by fatWrite() every FAT_WRITE_PENDING clusters.
+/// Returns TRUE if successful.
+unsigned char fatWriteSync(FatWriter* w);
+#endif
+
 #endif
@@ -0,0 +1,416 @@
+/*! \file flashlog.c \brief Log-structured record store for NOR flash. */
+//*****************************************************************************
+//
+// File Name	: 'flashlog.c'
+// Title		: Log-structured record store for NOR flash
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifdef __AVR__
+#include <util/crc16.h>
+#endif
+
+#include "global.h"
+#include "flashlog.h"
+
+#ifndef __AVR__
+// PC builds (flashlogsim.c): same CRC-CCITT as <util/crc16.h>
+static inline u16 _crc_ccitt_update(u16 crc, u08 data)
+{
+	data ^= (crc & 0xFF);
+	data ^= data << 4;
+	return ((((u16)data << 8) | (crc >> 8)) ^ (u08)(data >> 4) ^ ((u16)data << 3));
+}
+#endif
+
+// sector states
+#define FLASHLOG_INVALID		0		// no valid header, must be erased before use
+#define FLASHLOG_LIVE			1		// part of the log
+#define FLASHLOG_RETIRED		2		// dropped, waiting to be erased
+#define FLASHLOG_ERROR			0xFF	// header could not be read
+
+// sector header layout
+#define FLASHLOG_MAGIC0			'F'
+#define FLASHLOG_MAGIC1			'L'
+#define FLASHLOG_HDR_SEQ		2		// sequence number (2 bytes)
+#define FLASHLOG_HDR_ERASES		4		// erase count (4 bytes)
+#define FLASHLOG_HDR_CRC		8		// CRC of the bytes before it (2 bytes)
+#define FLASHLOG_HDR_RETIRED	10		// 0xFF while the sector is live
+#define FLASHLOG_HDR_WRITTEN	10		// bytes written with the header
+
+// flash address of an offset within a sector
+#define flashlogAddr(s, off)	((u32)(s)*FLASHLOG_SECTOR_SIZE + (off))
+// sequence number a is newer than b (allowing for wrap-around)
+#define flashlogNewer(a, b)		((s16)((u16)(a)-(u16)(b)) > 0)
+
+static u16 flashlogCrc(u16 crc, u08* data, u08 nbytes)
+{
+	while(nbytes--)
+		crc = _crc_ccitt_update(crc, *data++);
+	return crc;
+}
+
+// read a sector header, returning the sector state
+static u08 flashlogReadHeader(FlashLog* log, u08 s, u16* seq, u32* erases)
+{
+	u08 hdr[FLASHLOG_HDR_RETIRED+1];
+	u16 crc;
+
+	if(log->ops->read(log, flashlogAddr(s, 0), sizeof(hdr), hdr))
+		return FLASHLOG_ERROR;
+
+	crc = flashlogCrc(0xFFFF, hdr, FLASHLOG_HDR_CRC);
+	if( (hdr[0] != FLASHLOG_MAGIC0) || (hdr[1] != FLASHLOG_MAGIC1) ||
+		(hdr[FLASHLOG_HDR_CRC] != (u08)crc) || (hdr[FLASHLOG_HDR_CRC+1] != (u08)(crc>>8)) )
+		return FLASHLOG_INVALID;
+
+	*seq = hdr[FLASHLOG_HDR_SEQ] | (hdr[FLASHLOG_HDR_SEQ+1]<<8);
+	*erases = hdr[FLASHLOG_HDR_ERASES] | ((u32)hdr[FLASHLOG_HDR_ERASES+1]<<8) |
+		((u32)hdr[FLASHLOG_HDR_ERASES+2]<<16) | ((u32)hdr[FLASHLOG_HDR_ERASES+3]<<24);
+	// a partly programmed flag counts as retired
+	return (hdr[FLASHLOG_HDR_RETIRED] == 0xFF) ? FLASHLOG_LIVE : FLASHLOG_RETIRED;
+}
+
+// the oldest live sector
+static u08 flashlogOldest(FlashLog* log)
+{
+	u08 s, oldest = FLASHLOG_NONE;
+
+	for(s=0; s<log->sectors; s++)
+	{
+		if( (log->state[s] == FLASHLOG_LIVE) &&
+			((oldest == FLASHLOG_NONE) || flashlogNewer(log->seq[oldest], log->seq[s])) )
+			oldest = s;
+	}
+	return oldest;
+}
+
+// the live sector that follows sequence number seq in the log
+static u08 flashlogFollowing(FlashLog* log, u16 seq)
+{
+	u08 s, next = FLASHLOG_NONE;
+
+	for(s=0; s<log->sectors; s++)
+	{
+		if( (log->state[s] == FLASHLOG_LIVE) && flashlogNewer(log->seq[s], seq) &&
+			((next == FLASHLOG_NONE) || flashlogNewer(log->seq[next], log->seq[s])) )
+			next = s;
+	}
+	return next;
+}
+
+// mark a sector as dropped from the log
+static u08 flashlogRetire(FlashLog* log, u08 s)
+{
+	u08 flag = 0;
+
+	log->state[s] = FLASHLOG_RETIRED;
+	if(s == log->head)
+		log->head = FLASHLOG_NONE;
+	return log->ops->program(log, flashlogAddr(s, FLASHLOG_HDR_RETIRED), 1, &flag);
+}
+
+// erase a sector and start appending to it
+static u08 flashlogNewSector(FlashLog* log)
+{
+	u08 s, i, state;
+	u08 best = FLASHLOG_NONE;
+	u08 blank = FLASHLOG_NONE;
+	u08 hdr[FLASHLOG_HDR_WRITTEN];
+	u16 seq, crc;
+	u32 erases, most = 0, fewest = 0;
+
+	// find the dropped sector with the fewest erases, and the first sector
+	// without a valid header (looking from the head on, so that those are
+	// used in turn)
+	s = (log->head == FLASHLOG_NONE) ? log->sectors-1 : log->head;
+	for(i=0; i<log->sectors; i++)
+	{
+		if(++s >= log->sectors)
+			s = 0;
+		state = flashlogReadHeader(log, s, &seq, &erases);
+		if(state == FLASHLOG_ERROR)
+			return 1;
+		if(state == FLASHLOG_INVALID)
+		{
+			if(blank == FLASHLOG_NONE)
+				blank = s;
+			continue;
+		}
+		if(erases > most)
+			most = erases;
+		if( (state == FLASHLOG_RETIRED) && ((best == FLASHLOG_NONE) || (erases < fewest)) )
+		{
+			best = s;
+			fewest = erases;
+		}
+	}
+
+	// a sector without a header is new, or lost it while being erased, when
+	// it had been erased about as often as the rest: count it one erase
+	// short of the most worn sector
+	if(most)
+		most--;
+	if( (blank != FLASHLOG_NONE) && ((best == FLASHLOG_NONE) || (most < fewest)) )
+	{
+		best = blank;
+		fewest = most;
+	}
+
+	if(best == FLASHLOG_NONE)
+	{
+		// the log is full: drop the oldest sector
+		best = flashlogOldest(log);
+		if( (best == FLASHLOG_NONE) || (best == log->head) )
+			return 1;
+		if(flashlogReadHeader(log, best, &seq, &fewest) != FLASHLOG_LIVE)
+			return 1;
+	}
+
+	// the sector leaves the log while it is erased
+	log->state[best] = FLASHLOG_INVALID;
+	if(best == log->head)
+		log->head = FLASHLOG_NONE;
+	if(log->ops->erase(log, flashlogAddr(best, 0)))
+		return 1;
+
+	// write the header
+	fewest++;
+	hdr[0] = FLASHLOG_MAGIC0;
+	hdr[1] = FLASHLOG_MAGIC1;
+	hdr[FLASHLOG_HDR_SEQ]		= log->nextSeq;
+	hdr[FLASHLOG_HDR_SEQ+1]		= log->nextSeq>>8;
+	hdr[FLASHLOG_HDR_ERASES]	= fewest;
+	hdr[FLASHLOG_HDR_ERASES+1]	= fewest>>8;
+	hdr[FLASHLOG_HDR_ERASES+2]	= fewest>>16;
+	hdr[FLASHLOG_HDR_ERASES+3]	= fewest>>24;
+	crc = flashlogCrc(0xFFFF, hdr, FLASHLOG_HDR_CRC);
+	hdr[FLASHLOG_HDR_CRC]		= crc;
+	hdr[FLASHLOG_HDR_CRC+1]		= crc>>8;
+	if(log->ops->program(log, flashlogAddr(best, 0), FLASHLOG_HDR_WRITTEN, hdr))
+		return 1;
+
+	log->state[best] = FLASHLOG_LIVE;
+	log->seq[best] = log->nextSeq++;
+	log->head = best;
+	log->offset = FLASHLOG_HEADER_SIZE;
+	return 0;
+}
+
+void flashlogInit(FlashLog* log, const FlashLogOps* ops, u08 sectors)
+{
+	u08 s;
+
+	log->ops = ops;
+	log->sectors = (sectors > FLASHLOG_MAX_SECTORS) ? FLASHLOG_MAX_SECTORS : sectors;
+	log->head = FLASHLOG_NONE;
+	log->nextSeq = 0;
+	log->offset = 0;
+	for(s=0; s<FLASHLOG_MAX_SECTORS; s++)
+		log->state[s] = FLASHLOG_INVALID;
+}
+
+u08 flashlogMount(FlashLog* log)
+{
+	u08 s, state;
+	u08 rec[FLASHLOG_RECORD_HEADER];
+	u32 erases;
+
+	// read the sector headers and find the newest sector
+	log->head = FLASHLOG_NONE;
+	for(s=0; s<log->sectors; s++)
+	{
+		state = flashlogReadHeader(log, s, &log->seq[s], &erases);
+		if(state == FLASHLOG_ERROR)
+			return 1;
+		log->state[s] = state;
+		if( (state == FLASHLOG_LIVE) &&
+			((log->head == FLASHLOG_NONE) || flashlogNewer(log->seq[s], log->seq[log->head])) )
+			log->head = s;
+	}
+	if(log->head == FLASHLOG_NONE)
+	{
+		log->nextSeq = 0;
+		return 0;
+	}
+	log->nextSeq = log->seq[log->head]+1;
+
+	// follow the record lengths to the end of the newest sector
+	log->offset = FLASHLOG_HEADER_SIZE;
+	while(log->offset + FLASHLOG_RECORD_HEADER <= FLASHLOG_SECTOR_SIZE)
+	{
+		if(log->ops->read(log, flashlogAddr(log->head, log->offset), FLASHLOG_RECORD_HEADER, rec))
+			return 1;
+		if( (rec[0] & rec[1] & rec[2] & rec[3]) == 0xFF )
+			break;
+		if(rec[0] != (u08)~rec[1])
+		{
+			// cut short while being written: leave the rest of the sector
+			log->offset = FLASHLOG_SECTOR_SIZE;
+			break;
+		}
+		log->offset += FLASHLOG_RECORD_HEADER + rec[0];
+	}
+	return 0;
+}
+
+u08 flashlogAppend(FlashLog* log, u08* data, u08 len)
+{
+	u08 rec[FLASHLOG_RECORD_HEADER];
+	u16 crc;
+	u32 addr;
+
+	if( (log->head == FLASHLOG_NONE) ||
+		(log->offset + FLASHLOG_RECORD_HEADER + len > FLASHLOG_SECTOR_SIZE) )
+	{
+		if(flashlogNewSector(log))
+			return 1;
+	}
+
+	rec[0] = len;
+	rec[1] = ~len;
+	crc = _crc_ccitt_update(0xFFFF, len);
+	crc = flashlogCrc(crc, data, len);
+	rec[2] = crc;
+	rec[3] = crc>>8;
+
+	// program the record header first, so that a record whose data
+	// has been started always has a complete length
+	addr = flashlogAddr(log->head, log->offset);
+	if( log->ops->program(log, addr, FLASHLOG_RECORD_HEADER, rec) ||
+		(len && log->ops->program(log, addr+FLASHLOG_RECORD_HEADER, len, data)) )
+	{
+		// don't append after a record that may be damaged
+		log->offset = FLASHLOG_SECTOR_SIZE;
+		return 1;
+	}
+	log->offset += FLASHLOG_RECORD_HEADER + len;
+	return 0;
+}
+
+void flashlogRewind(FlashLog* log, FlashLogCursor* c)
+{
+	c->sector = flashlogOldest(log);
+	if(c->sector != FLASHLOG_NONE)
+		c->seq = log->seq[c->sector];
+	c->offset = FLASHLOG_HEADER_SIZE;
+}
+
+s16 flashlogNext(FlashLog* log, FlashLogCursor* c, u08* buffer, u08 size)
+{
+	u08 rec[FLASHLOG_RECORD_HEADER];
+	u08 chunk[16];
+	u08 s, n, k;
+	u16 i, crc;
+	u32 end, addr;
+
+	for(;;)
+	{
+		// start over from the oldest record if the sector has been dropped
+		if( (c->sector == FLASHLOG_NONE) ||
+			(log->state[c->sector] != FLASHLOG_LIVE) || (log->seq[c->sector] != c->seq) )
+		{
+			flashlogRewind(log, c);
+			if(c->sector == FLASHLOG_NONE)
+				return -1;
+		}
+
+		end = (c->sector == log->head) ? log->offset : FLASHLOG_SECTOR_SIZE;
+		if(c->offset + FLASHLOG_RECORD_HEADER <= end)
+		{
+			addr = flashlogAddr(c->sector, c->offset);
+			if(log->ops->read(log, addr, FLASHLOG_RECORD_HEADER, rec))
+				return -1;
+			// (an unwritten header fails this test too)
+			if( (rec[0] == (u08)~rec[1]) && (c->offset + FLASHLOG_RECORD_HEADER + rec[0] <= end) )
+			{
+				c->offset += FLASHLOG_RECORD_HEADER + rec[0];
+				addr += FLASHLOG_RECORD_HEADER;
+
+				// read the data through a small buffer to check the CRC
+				crc = _crc_ccitt_update(0xFFFF, rec[0]);
+				for(i=0; i<rec[0]; i+=n)
+				{
+					n = (rec[0]-i > sizeof(chunk)) ? sizeof(chunk) : rec[0]-i;
+					if(log->ops->read(log, addr+i, n, chunk))
+						return -1;
+					crc = flashlogCrc(crc, chunk, n);
+					for(k=0; k<n && i+k<size; k++)
+						buffer[i+k] = chunk[k];
+				}
+				if( (rec[2] == (u08)crc) && (rec[3] == (u08)(crc>>8)) )
+					return rec[0];
+				// damaged record
+				continue;
+			}
+		}
+
+		// no more records in this sector: move to the next one,
+		// or stay at the end of the log to pick up later records
+		if(c->sector == log->head)
+			return -1;
+		if((s = flashlogFollowing(log, c->seq)) == FLASHLOG_NONE)
+			return -1;
+		c->sector = s;
+		c->seq = log->seq[s];
+		c->offset = FLASHLOG_HEADER_SIZE;
+	}
+}
+
+u08 flashlogTrim(FlashLog* log, FlashLogCursor* c)
+{
+	u08 s;
+
+	if( (c->sector == FLASHLOG_NONE) ||
+		(log->state[c->sector] != FLASHLOG_LIVE) || (log->seq[c->sector] != c->seq) )
+		return 0;
+
+	for(s=0; s<log->sectors; s++)
+	{
+		if( (log->state[s] == FLASHLOG_LIVE) && flashlogNewer(c->seq, log->seq[s]) )
+		{
+			if(flashlogRetire(log, s))
+				return 1;
+		}
+	}
+	return 0;
+}
+
+u08 flashlogClear(FlashLog* log)
+{
+	u08 s;
+
+	for(s=0; s<log->sectors; s++)
+	{
+		if(log->state[s] == FLASHLOG_LIVE)
+		{
+			if(flashlogRetire(log, s))
+				return 1;
+		}
+	}
+	return 0;
+}
+
+u32 flashlogGetEraseCount(FlashLog* log, u08 sector)
+{
+	u16 seq;
+	u32 erases;
+
+	switch(flashlogReadHeader(log, sector, &seq, &erases))
+	{
+	case FLASHLOG_LIVE:
+	case FLASHLOG_RETIRED:
+		return erases;
+	default:
+		return 0;
+	}
+}
@@ -0,0 +1,183 @@
+/*! \file flashlog.h \brief Log-structured record store for NOR flash. */
+//*****************************************************************************
+//
+// File Name	: 'flashlog.h'
+// Title		: Log-structured record store for NOR flash
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+///	\ingroup general
+/// \defgroup flashlog Flash Record Log (flashlog.c)
+/// \code #include "flashlog.h" \endcode
+/// \par Overview
+///		Keeps a history of small records (alarms, events) in a serial NOR
+///		flash.  Records are only ever appended, so the flash is programmed
+///		sequentially and a sector is erased only when the log needs room
+///		for more records.  Once every sector is in use the oldest one is
+///		dropped, so the log holds the most recent history that fits.
+///	\par
+///		The log has no fixed superblock or table.  Each sector begins with a
+///		header holding a sequence number, which orders the sectors of the
+///		log, and the number of times the sector has been erased.  When a new
+///		sector is needed the free sector with the fewest erases is taken
+///		(the oldest sector, when none is free), so no sector wears faster
+///		than the rest.  flashlogMount() reads the sector headers and then
+///		walks the record headers of the newest sector to find the end of the
+///		log; it needs 3 bytes of RAM per sector.
+///	\par
+///		Each record is [length][~length][CRC-16 lo][CRC-16 hi][data...],
+///		with the CCITT CRC taken over the length and data bytes.  A record
+///		cut short by a power failure fails its CRC and is skipped when the
+///		log is read.  If the length bytes themselves were cut short the rest
+///		of that sector is left unused and the log continues in a new sector.
+///	\par
+///		The log reaches the flash through a table of operations
+///		(FlashLogOps).  spiflash.c provides one for SPI flash chips
+///		(spiflashLogOps) and, for testing on a PC, flashlogsim.c emulates a
+///		NOR flash in RAM and can cut the power in the middle of any program
+///		or erase.
+///	\code
+/// FlashLog history;
+/// FlashLogCursor c;
+/// u08 record[16];
+/// s16 len;
+///
+/// spiflashInit();
+/// flashlogInit(&history, &spiflashLogOps, 32);	// 2MB of 64K sectors
+/// flashlogMount(&history);
+/// flashlogAppend(&history, record, sizeof(record));
+/// ...
+/// flashlogRewind(&history, &c);
+/// while((len = flashlogNext(&history, &c, record, sizeof(record))) >= 0)
+/// 	...
+/// \endcode
+///	\note FLASHLOG_SECTOR_SIZE must match the area erased by the flash's
+///		sector erase command.
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+//@{
+
+#ifndef FLASHLOG_H
+#define FLASHLOG_H
+
+#include "global.h"
+
+#ifndef FLASHLOG_SECTOR_SIZE
+//! Size of the flash erase sector in bytes.
+/// Do not change this value in flashlog.h, but rather override
+/// it with the desired value defined in your project's global.h
+#define FLASHLOG_SECTOR_SIZE	0x10000
+#endif
+#ifndef FLASHLOG_MAX_SECTORS
+//! Largest number of sectors a log may use (3 bytes of RAM each).
+#define FLASHLOG_MAX_SECTORS	32
+#endif
+
+// constants
+#define FLASHLOG_HEADER_SIZE	16		///< bytes of sector header
+#define FLASHLOG_RECORD_HEADER	4		///< bytes of record header
+#define FLASHLOG_MAX_RECORD		255		///< largest record in bytes
+#define FLASHLOG_NONE			0xFF	///< no sector
+
+// structure/typdefs
+
+typedef struct struct_FlashLog FlashLog;
+
+//! Flash operations table.
+/// Addresses are byte addresses in the flash, and the operations return
+/// zero if successful.  program() may be asked to cross page boundaries.
+typedef struct struct_FlashLogOps
+{
+	u08 (*read)(FlashLog* log, u32 addr, u16 nbytes, u08* data);		///< read bytes
+	u08 (*program)(FlashLog* log, u32 addr, u16 nbytes, u08* data);	///< program erased bytes
+	u08 (*erase)(FlashLog* log, u32 addr);		///< erase the sector starting at addr
+} FlashLogOps;
+
+//! Log descriptor.
+struct struct_FlashLog
+{
+	const FlashLogOps* ops;	///< flash operations
+	void* priv;				///< flash driver private data
+	u08 sectors;			///< number of sectors in the log
+	u08 head;				///< sector being appended to (FLASHLOG_NONE if none)
+	u16 nextSeq;			///< sequence number of the next sector
+	u32 offset;				///< append offset within the head sector
+	u16 seq[FLASHLOG_MAX_SECTORS];		///< sequence number of each sector
+	u08 state[FLASHLOG_MAX_SECTORS];	///< state of each sector
+};
+
+//! Read position in a log.
+typedef struct struct_FlashLogCursor
+{
+	u08 sector;				///< sector being read
+	u16 seq;				///< sequence number of that sector
+	u32 offset;				///< offset of the next record within it
+} FlashLogCursor;
+
+// functions
+
+//! Initializes a log descriptor to use the first sectors of a flash.
+/// The log needs at least two sectors.  Call flashlogMount() before using the log.
+void flashlogInit(FlashLog* log, const FlashLogOps* ops, u08 sectors);
+
+//! Finds the sectors and the end of the log.
+/// Returns zero if successful.
+u08 flashlogMount(FlashLog* log);
+
+//! Appends a record of up to FLASHLOG_MAX_RECORD bytes.
+/// May erase a sector to make room, dropping the oldest records.
+/// Returns zero if successful.
+u08 flashlogAppend(FlashLog* log, u08* data, u08 len);
+
+//! Sets a cursor to the oldest record in the log.
+void flashlogRewind(FlashLog* log, FlashLogCursor* c);
+
+//! Reads the record at the cursor and advances the cursor.
+/// Copies up to size bytes into buffer and returns the length of the
+/// record, or -1 when there are no more records.  Damaged records are
+/// skipped.  A cursor at the end of the log picks up records appended
+/// later.  If the sector it was in has been dropped, the cursor moves
+/// to the oldest record.
+s16 flashlogNext(FlashLog* log, FlashLogCursor* c, u08* buffer, u08 size);
+
+//! Drops the sectors holding only records older than the cursor's.
+/// Use it to release history that has been saved elsewhere.  The sectors
+/// are only marked, and are erased when the log needs them again.
+/// Returns zero if successful.
+u08 flashlogTrim(FlashLog* log, FlashLogCursor* c);
+
+//! Drops all records (without erasing).
+/// Returns zero if successful.
+u08 flashlogClear(FlashLog* log);
+
+//! Returns the number of times a sector has been erased by the log,
+/// or 0 if it has no valid header.
+u32 flashlogGetEraseCount(FlashLog* log, u08 sector);
+
+#ifndef __AVR__
+//! Sets up a log on a NOR flash emulated in RAM (PC builds only, flashlogsim.c).
+/// The flash starts erased.  Returns zero if successful.
+u08 flashlogSimOpen(FlashLog* log, u08 sectors);
+//! Frees the flash emulated by flashlogSimOpen().
+void flashlogSimClose(FlashLog* log);
+//! Cuts the power during the ops-th program or erase from now.
+/// The operation is left half done and all later operations fail.
+/// Passing zero restores the power and disarms the power failure.
+void flashlogSimPowerFail(FlashLog* log, u32 ops);
+//! Returns TRUE if the power has been cut.
+u08 flashlogSimPowerLost(FlashLog* log);
+//! Returns the number of bytes programmed over bits that were not erased.
+u32 flashlogSimGetOverwrites(FlashLog* log);
+//! Returns the emulated flash contents.
+u08* flashlogSimGetMemory(FlashLog* log);
+#endif
+
+#endif
+//@}
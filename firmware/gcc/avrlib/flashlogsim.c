@@ -0,0 +1,162 @@
+/*! \file flashlogsim.c \brief Emulated NOR flash for testing the flash log. */
+//*****************************************************************************
+//
+// File Name	: 'flashlogsim.c'
+// Title		: Emulated NOR flash for testing the flash log
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: PC (Linux, for testing)
+// Editor Tabs	: 4
+//
+// Keeps the flash in RAM and behaves like NOR: programming can only clear
+// bits, and erasing sets a whole sector to 0xFF.  A power failure can be
+// armed to hit any later program or erase, which is then left with a random
+// part of its bits changed, and the flash stops responding until the power
+// is restored.  Build it with the host compiler together with flashlog.c.
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef __AVR__
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+#include "flashlog.h"
+
+// emulated flash state
+typedef struct
+{
+	u08* mem;				// flash contents
+	u32 size;				// flash size in bytes
+	u32 countdown;			// operations left until the power fails (0 if not armed)
+	u08 lost;				// power has failed
+	u32 overwrites;			// bytes programmed over cleared bits
+} FlashLogSim;
+
+// count an operation against an armed power failure
+static u08 flashlogSimFails(FlashLogSim* sim)
+{
+	if(sim->countdown && !--sim->countdown)
+	{
+		sim->lost = TRUE;
+		return TRUE;
+	}
+	return FALSE;
+}
+
+static u08 flashlogSimRead(FlashLog* log, u32 addr, u16 nbytes, u08* data)
+{
+	FlashLogSim* sim = (FlashLogSim*) log->priv;
+
+	if(sim->lost || (addr + nbytes > sim->size))
+		return 1;
+	memcpy(data, sim->mem + addr, nbytes);
+	return 0;
+}
+
+static u08 flashlogSimProgram(FlashLog* log, u32 addr, u16 nbytes, u08* data)
+{
+	FlashLogSim* sim = (FlashLogSim*) log->priv;
+	u08* p;
+
+	if(sim->lost || (addr + nbytes > sim->size))
+		return 1;
+	p = sim->mem + addr;
+	if(flashlogSimFails(sim))
+	{
+		// the cells are programmed in no particular order,
+		// so any of the bits being cleared may have been
+		while(nbytes--)
+			*p++ &= *data++ | (u08)rand();
+		return 1;
+	}
+	while(nbytes--)
+	{
+		if((*p & *data) != *data)
+			sim->overwrites++;
+		*p++ &= *data++;
+	}
+	return 0;
+}
+
+static u08 flashlogSimErase(FlashLog* log, u32 addr)
+{
+	FlashLogSim* sim = (FlashLogSim*) log->priv;
+	u08* p;
+	u32 n;
+
+	addr -= addr % FLASHLOG_SECTOR_SIZE;
+	if(sim->lost || (addr + FLASHLOG_SECTOR_SIZE > sim->size))
+		return 1;
+	p = sim->mem + addr;
+	if(flashlogSimFails(sim))
+	{
+		// any of the bits may have been set
+		for(n=0; n<FLASHLOG_SECTOR_SIZE; n++)
+			*p++ |= (u08)rand();
+		return 1;
+	}
+	memset(p, 0xFF, FLASHLOG_SECTOR_SIZE);
+	return 0;
+}
+
+static const FlashLogOps flashlogSimOps = {flashlogSimRead, flashlogSimProgram, flashlogSimErase};
+
+u08 flashlogSimOpen(FlashLog* log, u08 sectors)
+{
+	FlashLogSim* sim;
+
+	if( !(sim = calloc(1, sizeof(FlashLogSim))) )
+		return 1;
+	sim->size = (u32)sectors*FLASHLOG_SECTOR_SIZE;
+	if( !(sim->mem = malloc(sim->size)) )
+	{
+		free(sim);
+		return 1;
+	}
+	memset(sim->mem, 0xFF, sim->size);
+	flashlogInit(log, &flashlogSimOps, sectors);
+	log->priv = sim;
+	return 0;
+}
+
+void flashlogSimClose(FlashLog* log)
+{
+	FlashLogSim* sim = (FlashLogSim*) log->priv;
+
+	free(sim->mem);
+	free(sim);
+	log->priv = 0;
+}
+
+void flashlogSimPowerFail(FlashLog* log, u32 ops)
+{
+	FlashLogSim* sim = (FlashLogSim*) log->priv;
+
+	sim->countdown = ops;
+	if(!ops)
+		sim->lost = FALSE;
+}
+
+u08 flashlogSimPowerLost(FlashLog* log)
+{
+	return ((FlashLogSim*) log->priv)->lost;
+}
+
+u32 flashlogSimGetOverwrites(FlashLog* log)
+{
+	return ((FlashLogSim*) log->priv)->overwrites;
+}
+
+u08* flashlogSimGetMemory(FlashLog* log)
+{
+	return ((FlashLogSim*) log->priv)->mem;
+}
+
+#endif
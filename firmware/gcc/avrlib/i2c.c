@@ -19,6 +19,7 @@
 #include <avr/interrupt.h>
 
 #include "i2c.h"
+#include "isrstat.h"
 
 #include "rprintf.h"	// include printf function library
 #include "uart2.h"
@@ -363,6 +364,7 @@ void i2cMasterTransferNI(u08 deviceAddr, u08 sendlength, u08* senddata, u08 rece
 //! I2C (TWI) interrupt service routine
 SIGNAL(SIG_2WIRE_SERIAL)
 {
+	ISRSTAT_ENTER(ISRSTAT_TWI);
 	// read status bits
 	u08 status = inb(TWSR) & TWSR_STATUS_MASK;
 
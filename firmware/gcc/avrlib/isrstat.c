@@ -0,0 +1,156 @@
+/*! \file isrstat.c \brief Interrupt Timing Statistics. */
+//*****************************************************************************
+//
+// File Name	: 'isrstat.c'
+// Title		: Interrupt Timing Statistics
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#include "global.h"
+#include "isrstat.h"
+
+#ifdef ISRSTAT
+
+#include "rprintf.h"
+#include "timer.h"
+
+// statistics for one vector
+typedef struct
+{
+	u16 count;					// entries (saturates)
+	u16 min;					// shortest run in timer1 tics
+	u16 max;					// longest run in timer1 tics
+	u32 total;					// sum of runs counted in count
+} IsrStat;
+
+// global variables
+static IsrStat IsrStats[ISRSTAT_NUM];
+static u16 IsrStatMaxCritical;
+
+// vector names for isrstatDump(), in ISRSTAT_xxx order
+static const char __attribute__ ((progmem)) IsrStatNames[] =
+	"T0OVF\0T1OVF\0T2OVF\0T0COMP\0T1COMPA\0T1COMPB\0T1CAPT\0T2COMP\0"
+	"URX\0UTX\0ADC\0SPI\0TWI\0"
+	"INT0\0INT1\0INT2\0INT3\0INT4\0INT5\0INT6\0INT7";
+
+// functions
+
+void isrstatInit(void)
+{
+	#ifdef ISRSTAT_DEBUG_PORT
+	cbi(ISRSTAT_DEBUG_PORT, ISRSTAT_DEBUG_PIN);
+	sbi(ISRSTAT_DEBUG_DDR, ISRSTAT_DEBUG_PIN);
+	#endif
+	isrstatClear();
+}
+
+void isrstatClear(void)
+{
+	u08 i;
+	u08 sreg = SREG;
+	cli();
+	for(i=0; i<ISRSTAT_NUM; i++)
+	{
+		IsrStats[i].count = 0;
+		IsrStats[i].min = 0xFFFF;
+		IsrStats[i].max = 0;
+		IsrStats[i].total = 0;
+	}
+	IsrStatMaxCritical = 0;
+	SREG = sreg;
+}
+
+u16 isrstatGetMaxCritical(void)
+{
+	u16 max;
+	u08 sreg = SREG;
+	cli();
+	max = IsrStatMaxCritical;
+	SREG = sreg;
+	return max;
+}
+
+void isrstatDump(void)
+{
+	u08 i, n;
+	IsrStat s;
+	const char* name = IsrStatNames;
+
+	rprintfProgStrM("timer1 clk/");
+	rprintfNum(10, 4, FALSE, ' ', timer1GetPrescaler());
+	rprintfCRLF();
+	rprintfProgStrM("vector   count    min    avg    max\r\n");
+	for(i=0; i<ISRSTAT_NUM; i++)
+	{
+		// take a consistent copy
+		cli();
+		s = IsrStats[i];
+		sei();
+		if(s.count)
+		{
+			rprintfProgStr(name);
+			// pad the name to 7 characters
+			for(n=strlen_P(name); n<7; n++)
+				rprintfChar(' ');
+			rprintfNum(10, 7, FALSE, ' ', s.count);
+			rprintfNum(10, 7, FALSE, ' ', s.min);
+			rprintfNum(10, 7, FALSE, ' ', s.total / s.count);
+			rprintfNum(10, 7, FALSE, ' ', s.max);
+			rprintfCRLF();
+		}
+		// skip to the next name
+		name += strlen_P(name) + 1;
+	}
+	rprintfProgStrM("cli max");
+	rprintfNum(10, 28, FALSE, ' ', isrstatGetMaxCritical());
+	rprintfCRLF();
+}
+
+// Called through the cleanup attribute of the frame that ISRSTAT_ENTER()
+// declares, so it runs on every exit from the handler.  Handlers run
+// with interrupts disabled, so no locking is needed.
+void isrstatLeave(IsrStatFrame* frame)
+{
+	u16 tics = TCNT1 - frame->start;
+	IsrStat* s = &IsrStats[frame->id];
+
+	#ifdef ISRSTAT_DEBUG_PORT
+	cbi(ISRSTAT_DEBUG_PORT, ISRSTAT_DEBUG_PIN);
+	#endif
+
+	// stop accumulating when the count saturates so the average stays right
+	if(s->count != 0xFFFF)
+	{
+		s->count++;
+		s->total += tics;
+	}
+	if(tics < s->min)
+		s->min = tics;
+	if(tics > s->max)
+		s->max = tics;
+}
+
+// Called at the end of a critical section, before SREG is restored.
+// Only outermost sections (entered with interrupts enabled) are measured;
+// sections nested in handlers or other sections are already covered.
+void isrstatCritical(u08 sreg, u16 start)
+{
+	u16 tics = TCNT1 - start;
+	if((sreg & BV(SREG_I)) && (tics > IsrStatMaxCritical))
+		IsrStatMaxCritical = tics;
+}
+
+#endif
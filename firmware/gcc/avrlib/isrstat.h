@@ -0,0 +1,125 @@
+/*! \file isrstat.h \brief Interrupt Timing Statistics. */
+//*****************************************************************************
+//
+// File Name	: 'isrstat.h'
+// Title		: Interrupt Timing Statistics
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+///	\ingroup general
+/// \defgroup isrstat Interrupt Timing Statistics (isrstat.c)
+/// \code #include "isrstat.h" \endcode
+/// \par Overview
+///		Optional instrumentation of the library interrupt handlers (timer,
+///		uart, extint, a2d, spi, i2c).  For every handler it counts the
+///		number of entries and keeps the shortest, longest and average
+///		execution time, measured from TCNT1 snapshots.  It also records
+///		the longest window with interrupts disabled by the library critical
+///		sections (buffer, swtimer), which together with the longest handler
+///		bounds the interrupt latency the rest of the system can see.
+///	\par
+///		Define ISRSTAT in your project's global.h to compile it in.  Without
+///		it the ISRSTAT_ENTER() hooks compile to nothing and isrstat.c is
+///		empty.  Times are in timer1 tics, so run timer1 at TIMER_CLK_DIV1
+///		for cycle resolution.  Each measurement includes the few cycles it
+///		takes to read TCNT1 and make the call that records it.
+///	\par
+///		Define ISRSTAT_DEBUG_PORT, ISRSTAT_DEBUG_DDR and ISRSTAT_DEBUG_PIN to
+///		also drive a pin high while an instrumented handler runs, for
+///		correlation with other signals on a scope.
+///	\code
+/// isrstatInit();
+/// cmdlineAddCommand("isrstat", isrstatDump);
+/// \endcode
+///	\note The statistics take 10 bytes of RAM per vector.
+///	\note Instrumented handlers read TCNT1, which uses the shared 16-bit
+///		TEMP register; main code that writes 16-bit timer1 registers
+///		(OCR1A, ICR1, ...) should do so with interrupts disabled.
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+//@{
+
+#ifndef ISRSTAT_H
+#define ISRSTAT_H
+
+#include "global.h"
+
+// instrumented vectors
+#define ISRSTAT_TIMER0OVF		0	///< timer0 overflow
+#define ISRSTAT_TIMER1OVF		1	///< timer1 overflow
+#define ISRSTAT_TIMER2OVF		2	///< timer2 overflow
+#define ISRSTAT_TIMER0COMP		3	///< timer0 output compare
+#define ISRSTAT_TIMER1COMPA		4	///< timer1 output compare A
+#define ISRSTAT_TIMER1COMPB		5	///< timer1 output compare B
+#define ISRSTAT_TIMER1CAPT		6	///< timer1 input capture
+#define ISRSTAT_TIMER2COMP		7	///< timer2 output compare
+#define ISRSTAT_UART_RX			8	///< uart receive complete
+#define ISRSTAT_UART_TX			9	///< uart transmit complete
+#define ISRSTAT_ADC				10	///< a2d conversion complete
+#define ISRSTAT_SPI				11	///< spi transfer complete
+#define ISRSTAT_TWI				12	///< i2c (TWI) state change
+#define ISRSTAT_INT0			13	///< external interrupt 0 (INT1-INT7 follow)
+#define ISRSTAT_NUM				21	///< number of instrumented vectors
+
+#ifdef ISRSTAT
+
+// state of one instrumented handler invocation
+typedef struct
+{
+	u08 id;						///< vector being measured
+	u16 start;					///< TCNT1 at entry
+} IsrStatFrame;
+
+// debug pin
+#ifdef ISRSTAT_DEBUG_PORT
+#define ISRSTAT_DEBUG_ON()		sbi(ISRSTAT_DEBUG_PORT, ISRSTAT_DEBUG_PIN)
+#else
+#define ISRSTAT_DEBUG_ON()
+#endif
+
+//! Instruments the interrupt handler it is placed in.
+/// Put it first in the handler body.  The measurement is closed on every
+/// path out of the handler, including early returns.
+#define ISRSTAT_ENTER(vector) \
+	IsrStatFrame _isrstat __attribute__ ((cleanup(isrstatLeave))); \
+	ISRSTAT_DEBUG_ON(); _isrstat.id = (vector); _isrstat.start = TCNT1
+
+// instrumented critical sections for the libraries that allow overriding them
+#define CRITICAL_SECTION_START	unsigned char _sreg = SREG; cli(); u16 _isrstatCs = TCNT1
+#define CRITICAL_SECTION_END	isrstatCritical(_sreg, _isrstatCs); SREG = _sreg
+
+// functions
+
+//! Initializes the debug pin (if any) and clears the statistics.
+void isrstatInit(void);
+
+//! Clears the statistics.
+void isrstatClear(void);
+
+//! Prints the statistics of the vectors that have run, and the longest
+/// interrupts-disabled window, using rprintf.
+/// Takes no arguments, so it can be registered as a cmdline command.
+void isrstatDump(void);
+
+//! Returns the longest interrupts-disabled window in timer1 tics.
+u16 isrstatGetMaxCritical(void);
+
+// internal hooks used by the macros above
+void isrstatLeave(IsrStatFrame* frame);
+void isrstatCritical(u08 sreg, u16 start);
+
+#else
+
+#define ISRSTAT_ENTER(vector)
+
+#endif
+
+#endif
+//@}
@@ -131,6 +131,28 @@ cBuffer* megaioGetRxBuffer(void)
 	return &megaioUartRxBuffer;
 }
 
+//! flush (delete) all received data
+void megaioFlushReceiveBuffer(void)
+{
+	// pull everything off the chip, then discard it
+	bufferFlush(megaioGetRxBuffer());
+}
+
+//! get a byte via the local receive buffer
+// (megaioGetByte() reads the chip directly and would skip any bytes
+//  already moved into the local buffer by megaioGetRxBuffer())
+static int megaioStreamGetByte(void)
+{
+	cBuffer* rxBuffer = megaioGetRxBuffer();
+	if(rxBuffer->datalength)
+		return bufferGetFromFront(rxBuffer);
+	else
+		return -1;
+}
+
+// byte-stream operations
+const StreamOps megaioStreamOps = {megaioSendByte, megaioStreamGetByte, megaioGetRxBuffer, megaioFlushReceiveBuffer};
+
 //! turn on megaio PWM and set for bitRes resolution
 void megaioPWMInit(u08 bitRes)
 {
@@ -18,6 +18,7 @@
 #ifndef MEGAIO_H
 #define MEGAIO_H
 
+#include "stream.h"
 #include "megaio/megaioreg.h"	// include MegaIO register definitions
 
 // defines
@@ -39,6 +40,10 @@ void megaioSendByte(u08 data);
 int megaioGetByte(void);
 //! get a complete receive buffer with data from MegaIO serial port
 cBuffer* megaioGetRxBuffer(void);
+void megaioFlushReceiveBuffer(void);
+
+//! byte-stream operations for the megaio serial port
+extern const StreamOps megaioStreamOps;
 
 //! turn on MegaIO PWM and set for bitRes resolution
 void megaioPWMInit(u08 bitRes);
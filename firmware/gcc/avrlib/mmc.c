@@ -33,7 +33,22 @@
 // include project-specific hardware configuration
 #include "mmcconf.h"
 
+#ifndef MMC_INIT_CLOCK
+#define MMC_INIT_CLOCK		SPI_CLK_DIV128
+#endif
+#ifndef MMC_CLOCK
+#define MMC_CLOCK			SPI_CLK_DIV2
+#endif
+
 // Global variables
+static u08 MmcCardType;
+
+// card address of a sector (SDHC cards are block addressed)
+#define mmcAddress(sector)	((MmcCardType == MMC_CARD_SDHC) ? (sector) : (sector)<<9)
+
+// local functions
+static u08 mmcReadData(u08* buffer, u16 length);
+static void mmcSendFrame(u08 cmd, u32 arg);
 
 // Functions
 
@@ -46,11 +61,42 @@ void mmcInit(void)
 	sbi(MMC_CS_PORT,MMC_CS_PIN);
 }
 
+// issue a command with a 32-bit response following R1 (R3/R7)
+static u08 mmcCommandLong(u08 cmd, u32 arg, u32* response)
+{
+	u08 r1;
+	u08 i;
+
+	// assert chip select
+	cbi(MMC_CS_PORT,MMC_CS_PIN);
+	// issue the command
+	r1 = mmcCommand(cmd, arg);
+	// read the rest of the response, MSB first
+	*response = 0;
+	for(i=0; i<4; i++)
+		*response = (*response<<8) | spiTransferByte(0xFF);
+	// release chip select
+	sbi(MMC_CS_PORT,MMC_CS_PIN);
+
+	return r1;
+}
+
+// issue an SD application command
+static u08 mmcAppCommand(u08 cmd, u32 arg)
+{
+	mmcSendCommand(MMC_APP_CMD, 0);
+	return mmcSendCommand(cmd, arg);
+}
+
 u08 mmcReset(void)
 {
 	u08 i;
-	u08 retry;
+	u16 retry;
 	u08 r1=0;
+	u32 response;
+
+	MmcCardType = MMC_CARD_NONE;
+	spiSetClock(MMC_INIT_CLOCK);
 
 	retry = 0;
 	do
@@ -67,21 +113,55 @@ u08 mmcReset(void)
 		if(retry>10) return -1;
 	} while(r1 != 0x01);
 
-	// TODO: check card parameters for voltage compliance
-	// before issuing initialize command
+	// check for a version 2 SD card: it echoes the check pattern back
+	// and confirms the 2.7-3.6V range
+	r1 = mmcCommandLong(MMC_SEND_IF_COND, 0x1AA, &response);
+	#ifdef MMC_DEBUG
+	rprintf("MMC_SEND_IF_COND: R1=0x%x\r\n", r1);
+	#endif
+	if(!(r1 & MMC_R1_ILLEGAL_COM))
+	{
+		if((response & 0xFFF) != 0x1AA)
+			return -1;
+		MmcCardType = MMC_CARD_SD2;
+	}
+	else
+	{
+		// version 1 SD card or MMC: SD cards accept ACMD41
+		MmcCardType = MMC_CARD_SD1;
+		if(mmcAppCommand(MMC_SD_SEND_OP_COND, 0) & MMC_R1_ILLEGAL_COM)
+			MmcCardType = MMC_CARD_MMC;
+	}
 
 	retry = 0;
 	do
 	{
 		// initializing card for operation
-		r1 = mmcSendCommand(MMC_SEND_OP_COND, 0);
+		// (SD v2 hosts announce high capacity support with HCS)
+		if(MmcCardType == MMC_CARD_MMC)
+			r1 = mmcSendCommand(MMC_SEND_OP_COND, 0);
+		else
+			r1 = mmcAppCommand(MMC_SD_SEND_OP_COND, (MmcCardType == MMC_CARD_SD2) ? 0x40000000 : 0);
 		#ifdef MMC_DEBUG
 		rprintf("MMC_SEND_OP_COND: R1=0x%x\r\n", r1);
 		#endif
-		// do retry counter
+		// do retry counter (cards may take up to a second)
 		retry++;
-		if(retry>100) return -1;
+		if(retry>1000) return -1;
 	} while(r1);
+
+	if(MmcCardType == MMC_CARD_SD2)
+	{
+		// card capacity status bit in the OCR selects block addressing
+		r1 = mmcCommandLong(MMC_READ_OCR, 0, &response);
+		#ifdef MMC_DEBUG
+		rprintf("MMC_READ_OCR: R1=0x%x\r\n", r1);
+		#endif
+		if(r1)
+			return -1;
+		if(response & 0x40000000)
+			MmcCardType = MMC_CARD_SDHC;
+	}
 		
 	// turn off CRC checking to simplify communication
 	r1 = mmcSendCommand(MMC_CRC_ON_OFF, 0);
@@ -89,16 +169,56 @@ u08 mmcReset(void)
 	rprintf("MMC_CRC_ON_OFF: R1=0x%x\r\n", r1);
 	#endif
 
-	// set block length to 512 bytes
-	r1 = mmcSendCommand(MMC_SET_BLOCKLEN, 512);
-	#ifdef MMC_DEBUG
-	rprintf("MMC_SET_BLOCKLEN: R1=0x%x\r\n", r1);
-	#endif
+	// set block length to 512 bytes (fixed on SDHC cards)
+	if(MmcCardType != MMC_CARD_SDHC)
+	{
+		r1 = mmcSendCommand(MMC_SET_BLOCKLEN, 512);
+		#ifdef MMC_DEBUG
+		rprintf("MMC_SET_BLOCKLEN: R1=0x%x\r\n", r1);
+		#endif
+	}
+
+	// the card is ready for full speed
+	spiSetClock(MMC_CLOCK);
 
 	// return success
 	return 0;
 }
 
+u08 mmcGetCardType(void)
+{
+	return MmcCardType;
+}
+
+u32 mmcGetCapacity(void)
+{
+	u08 csd[16];
+	u08 r1;
+	u32 size;
+
+	// read the 16-byte CSD register as a data block
+	cbi(MMC_CS_PORT,MMC_CS_PIN);
+	r1 = mmcCommand(MMC_SEND_CSD, 0);
+	if(r1 == 0x00)
+		r1 = mmcReadData(csd, sizeof(csd));
+	sbi(MMC_CS_PORT,MMC_CS_PIN);
+	if(r1)
+		return 0;
+
+	if((csd[0]>>6) == 1)
+	{
+		// CSD version 2.0: C_SIZE counts 512KB units
+		size = ((u32)(csd[7] & 0x3F)<<16) | ((u16)csd[8]<<8) | csd[9];
+		return (size+1) << 10;
+	}
+	else
+	{
+		// CSD version 1.0: (C_SIZE+1) * 2^(C_SIZE_MULT+2) blocks of 2^READ_BL_LEN bytes
+		size = ((u16)(csd[6] & 0x03)<<10) | ((u16)csd[7]<<2) | (csd[8]>>6);
+		return (size+1) << ((((csd[9] & 0x03)<<1) | (csd[10]>>7)) + 2 + (csd[5] & 0x0F) - 9);
+	}
+}
+
 u08 mmcSendCommand(u08 cmd, u32 arg)
 {
 	u08 r1;
@@ -113,90 +233,220 @@ u08 mmcSendCommand(u08 cmd, u32 arg)
 	return r1;
 }
 
+// wait for a data start token (or error token) from the card
+static u08 mmcWaitStart(void)
+{
+	u16 retry=0;
+	u08 token;
+	while((token = spiTransferByte(0xFF)) == 0xFF)
+		if(++retry == 0) break;
+	return token;
+}
+
+// read a data packet: length bytes and the (unused) CRC
+static u08 mmcReadData(u08* buffer, u16 length)
+{
+	u08 token;
+	// wait for block start
+	if((token = mmcWaitStart()) != MMC_STARTBLOCK_READ)
+		return token;
+	// read in data
+	spiReceiveBlock(buffer, length);
+	// read 16-bit CRC
+	spiTransferByte(0xFF);
+	spiTransferByte(0xFF);
+	return 0;
+}
+
+// send the data packet of one block and wait while the card programs it
+static u08 mmcWriteData(u08 token, u08* buffer)
+{
+	u08 r1;
+	// send dummy
+	spiTransferByte(0xFF);
+	// send data start token
+	spiTransferByte(token);
+	// write data
+	spiSendBlock(buffer, 0x200);
+	// write 16-bit CRC (dummy values)
+	spiTransferByte(0xFF);
+	spiTransferByte(0xFF);
+	// read data response token
+	r1 = spiTransferByte(0xFF);
+	#ifdef MMC_DEBUG
+	rprintf("Data Response Token=0x%x\r\n", r1);
+	#endif
+	if( (r1&MMC_DR_MASK) != MMC_DR_ACCEPT)
+		return r1;
+	// wait until card not busy
+	while(!spiTransferByte(0xFF));
+	return 0;
+}
+
 u08 mmcRead(u32 sector, u08* buffer)
 {
 	u08 r1;
-	u16 i;
 
 	// assert chip select
 	cbi(MMC_CS_PORT,MMC_CS_PIN);
 	// issue command
-	r1 = mmcCommand(MMC_READ_SINGLE_BLOCK, sector<<9);
+	r1 = mmcCommand(MMC_READ_SINGLE_BLOCK, mmcAddress(sector));
 	#ifdef MMC_DEBUG
 	rprintf("MMC Read Block R1=0x%x\r\n", r1);
 	#endif
-	// check for valid response
-	if(r1 != 0x00)
-		return r1;
-	// wait for block start
-	while(spiTransferByte(0xFF) != MMC_STARTBLOCK_READ);
-	// read in data
-	for(i=0; i<0x200; i++)
-	{
-		*buffer++ = spiTransferByte(0xFF);
-	}
-	// read 16-bit CRC
-	spiTransferByte(0xFF);
-	spiTransferByte(0xFF);
+	// check for valid response, then read the block
+	if(r1 == 0x00)
+		r1 = mmcReadData(buffer, 0x200);
 	// release chip select
 	sbi(MMC_CS_PORT,MMC_CS_PIN);
-	// return success
-	return 0;
+	return r1;
 }
 
 u08 mmcWrite(u32 sector, u08* buffer)
 {
 	u08 r1;
-	u16 i;
 
 	// assert chip select
 	cbi(MMC_CS_PORT,MMC_CS_PIN);
 	// issue command
-	r1 = mmcCommand(MMC_WRITE_BLOCK, sector<<9);
+	r1 = mmcCommand(MMC_WRITE_BLOCK, mmcAddress(sector));
 	#ifdef MMC_DEBUG
 	rprintf("MMC Write Block R1=0x%x\r\n", r1);
 	#endif
-	// check for valid response
-	if(r1 != 0x00)
-		return r1;
-	// send dummy
-	spiTransferByte(0xFF);
-	// send data start token
-	spiTransferByte(MMC_STARTBLOCK_WRITE);
-	// write data
-	for(i=0; i<0x200; i++)
+	// check for valid response, then write the block
+	if(r1 == 0x00)
+		r1 = mmcWriteData(MMC_STARTBLOCK_WRITE, buffer);
+	// release chip select
+	sbi(MMC_CS_PORT,MMC_CS_PIN);
+	return r1;
+}
+
+u08 mmcReadMulti(u32 sector, u16 count, u08* buffer, MmcStreamFunc func)
+{
+	u08 r1;
+	u08 retry;
+	u16 n;
+
+	if(!count)
+		return 0;
+	// assert chip select
+	cbi(MMC_CS_PORT,MMC_CS_PIN);
+	// issue command
+	r1 = mmcCommand(MMC_READ_MULTIPLE_BLOCK, mmcAddress(sector));
+	#ifdef MMC_DEBUG
+	rprintf("MMC Read Multi R1=0x%x\r\n", r1);
+	#endif
+	if(r1 == 0x00)
 	{
-		spiTransferByte(*buffer++);
+		// the card streams blocks until told to stop
+		for(n=0; n<count; n++)
+		{
+			if((r1 = mmcReadData(buffer, 0x200)))
+				break;
+			if(func)
+			{
+				if(func(n, buffer))
+					break;
+			}
+			else
+				buffer += 0x200;
+		}
+		// stop the transfer: the byte after the command is a stuff byte
+		// (or still data), then R1 follows and the card may hold the line
+		// busy afterwards
+		mmcSendFrame(MMC_STOP_TRANSMISSION, 0);
+		spiTransferByte(0xFF);
+		retry = 0;
+		while((spiTransferByte(0xFF) & 0x80) && (retry++ < 8));
+		while(!spiTransferByte(0xFF));
 	}
-	// write 16-bit CRC (dummy values)
-	spiTransferByte(0xFF);
-	spiTransferByte(0xFF);
-	// read data response token
-	r1 = spiTransferByte(0xFF);
-	if( (r1&MMC_DR_MASK) != MMC_DR_ACCEPT)
-		return r1;
+	// release chip select
+	sbi(MMC_CS_PORT,MMC_CS_PIN);
+	return r1;
+}
+
+u08 mmcWriteMulti(u32 sector, u16 count, u08* buffer, MmcStreamFunc func)
+{
+	u08 r1;
+	u16 n;
+
+	if(!count)
+		return 0;
+	// let SD cards pre-erase the blocks; not when the callback may end the
+	// transfer early, as pre-erased blocks that are not written are lost
+	if( (MmcCardType != MMC_CARD_MMC) && !func )
+		mmcAppCommand(MMC_SET_WR_BLK_ERASE_COUNT, count);
+	// assert chip select
+	cbi(MMC_CS_PORT,MMC_CS_PIN);
+	// issue command
+	r1 = mmcCommand(MMC_WRITE_MULTIPLE_BLOCK, mmcAddress(sector));
 	#ifdef MMC_DEBUG
-	rprintf("Data Response Token=0x%x\r\n", r1);
+	rprintf("MMC Write Multi R1=0x%x\r\n", r1);
 	#endif
-	// wait until card not busy
-	while(!spiTransferByte(0xFF));
+	if(r1 == 0x00)
+	{
+		for(n=0; n<count; n++)
+		{
+			if(func)
+			{
+				if(func(n, buffer))
+					break;
+			}
+			if((r1 = mmcWriteData(MMC_STARTBLOCK_MWRITE, buffer)))
+				break;
+			if(!func)
+				buffer += 0x200;
+		}
+		// end the transfer and wait until the card has finished programming
+		spiTransferByte(MMC_STOPTRAN_WRITE);
+		spiTransferByte(0xFF);
+		while(!spiTransferByte(0xFF));
+	}
 	// release chip select
 	sbi(MMC_CS_PORT,MMC_CS_PIN);
-	// return success
-	return 0;
+	return r1;
 }
 
-u08 mmcCommand(u08 cmd, u32 arg)
+// block device operations
+static u08 mmcBlockRead(BlockDev* dev, u32 block, u16 count, u08* buffer)
+{
+	if(count == 1)
+		return mmcRead(block, buffer);
+	return mmcReadMulti(block, count, buffer, 0);
+}
+
+static u08 mmcBlockWrite(BlockDev* dev, u32 block, u16 count, u08* buffer)
+{
+	if(count == 1)
+		return mmcWrite(block, buffer);
+	return mmcWriteMulti(block, count, buffer, 0);
+}
+
+const BlockDevOps mmcBlockDevOps = {mmcBlockRead, mmcBlockWrite, 0};
+
+void mmcBlockDevInit(BlockDev* dev)
+{
+	blockdevInit(dev, &mmcBlockDevOps, mmcGetCapacity());
+}
+
+// send a command frame without waiting for the response
+static void mmcSendFrame(u08 cmd, u32 arg)
 {
-	u08 r1;
-	u08 retry=0;
-	// send command
 	spiTransferByte(cmd | 0x40);
 	spiTransferByte(arg>>24);
 	spiTransferByte(arg>>16);
 	spiTransferByte(arg>>8);
 	spiTransferByte(arg);
-	spiTransferByte(0x95);	// crc valid only for MMC_GO_IDLE_STATE
+	// crc, checked only for MMC_GO_IDLE_STATE and MMC_SEND_IF_COND
+	spiTransferByte((cmd == MMC_SEND_IF_COND) ? 0x87 : 0x95);
+}
+
+u08 mmcCommand(u08 cmd, u32 arg)
+{
+	u08 r1;
+	u08 retry=0;
+	// send command
+	mmcSendFrame(cmd, arg);
 	// end command
 	// wait for response
 	// if more than 8 retries, card has timed-out
@@ -57,17 +57,24 @@
 #define MMC_H
 
 #include "global.h"
+#include "blockdev.h"
 
 // constants/macros/typdefs
 // MMC commands (taken from sandisk MMC reference)
 #define MMC_GO_IDLE_STATE			0		///< initialize card to SPI-type access
 #define MMC_SEND_OP_COND			1		///< set card operational mode
+#define MMC_SEND_IF_COND			8		///< (SD v2) check operating voltage, R7 response
 #define MMC_SEND_CSD				9		///< get card's CSD
 #define MMC_SEND_CID				10		///< get card's CID
+#define MMC_STOP_TRANSMISSION		12		///< end a multiple block read
 #define MMC_SEND_STATUS				13
 #define MMC_SET_BLOCKLEN			16		///< Set number of bytes to transfer per block
 #define MMC_READ_SINGLE_BLOCK		17		///< read a block
+#define MMC_READ_MULTIPLE_BLOCK		18		///< read blocks until MMC_STOP_TRANSMISSION
+#define MMC_SET_WR_BLK_ERASE_COUNT	23		///< (SD, app command) number of blocks to pre-erase
+#define MMC_SD_SEND_OP_COND			41		///< (SD, app command) start initialization
 #define MMC_WRITE_BLOCK				24		///< write a block
+#define MMC_WRITE_MULTIPLE_BLOCK	25		///< write blocks until the stop token
 #define MMC_PROGRAM_CSD				27
 #define MMC_SET_WRITE_PROT			28
 #define MMC_CLR_WRITE_PROT			29
@@ -79,6 +86,8 @@
 #define MMC_TAG_ERARE_GROUP_END		36		///< Sets end of erase group (mass erase)
 #define MMC_UNTAG_ERASE_GROUP		37		///< Untag (unset) erase group (mass erase)
 #define MMC_ERASE					38		///< Perform block/mass erase
+#define MMC_APP_CMD					55		///< (SD) next command is an application command
+#define MMC_READ_OCR				58		///< read operating conditions register, R3 response
 #define MMC_CRC_ON_OFF				59		///< Turns CRC check on/off
 // R1 Response bit-defines
 #define MMC_R1_BUSY					0x80	///< R1 response: bit indicates card is busy
@@ -107,6 +116,17 @@
 #define MMC_DR_ACCEPT				0x05
 #define MMC_DR_REJECT_CRC			0x0B
 #define MMC_DR_REJECT_WRITE_ERROR	0x0D
+// Card types (mmcGetCardType)
+#define MMC_CARD_NONE				0		///< no card initialized
+#define MMC_CARD_MMC				1		///< MultiMedia card
+#define MMC_CARD_SD1				2		///< SD card, version 1.x
+#define MMC_CARD_SD2				3		///< SD card, version 2.0 standard capacity
+#define MMC_CARD_SDHC				4		///< SDHC/SDXC card (block addressed)
+
+//! Streaming callback for mmcReadMulti() and mmcWriteMulti().
+/// Called with the block number within the transfer (0, 1, ...) and the
+/// block buffer.  Return zero to continue, or non-zero to end the transfer.
+typedef u08 (*MmcStreamFunc)(u16 n, u08* buffer);
 
 // functions
 
@@ -115,9 +135,18 @@
 void mmcInit(void);
 
 //! Initialize the card and prepare it for use.
+/// Identifies MMC, SD v1, SD v2 and SDHC/SDXC cards, initializing at
+/// MMC_INIT_CLOCK and switching the SPI clock to MMC_CLOCK when done.
 /// Returns zero if successful.
 u08 mmcReset(void);
 
+//! Returns the type of card found by mmcReset() (MMC_CARD_xxx).
+u08 mmcGetCardType(void);
+
+//! Returns the card capacity in 512-byte sectors, read from its CSD.
+/// Returns zero if the CSD could not be read.
+u32 mmcGetCapacity(void);
+
 //! Send card an MMC command.
 /// Returns R1 result code.
 u08 mmcSendCommand(u08 cmd, u32 arg);
@@ -130,6 +159,30 @@ u08 mmcRead(u32 sector, u08* buffer);
 /// Returns zero if successful.
 u08 mmcWrite(u32 sector, u08* buffer);
 
+//! Read up to count consecutive sectors with a single command (CMD18).
+/// If func is zero the sectors are stored one after another starting at
+/// buffer.  Otherwise each sector is read into the same 512-byte buffer and
+/// func is called to consume it; the transfer ends early if it returns
+/// non-zero.  Returns zero if successful.
+u08 mmcReadMulti(u32 sector, u16 count, u08* buffer, MmcStreamFunc func);
+
+//! Write up to count consecutive sectors with a single command (CMD25).
+/// If func is zero the sectors are taken one after another from buffer.
+/// Otherwise func is called before each sector to fill the 512-byte buffer;
+/// the transfer ends (without writing that sector) if it returns non-zero.
+/// Without func, SD cards are told the count first (ACMD23) so they can
+/// pre-erase.  This is skipped with func, because blocks that are
+/// pre-erased and then not written lose their contents.
+/// Returns zero if successful.
+u08 mmcWriteMulti(u32 sector, u16 count, u08* buffer, MmcStreamFunc func);
+
+//! Block device operations for the card (see blockdev.h).
+extern const BlockDevOps mmcBlockDevOps;
+
+//! Sets up a block device for the card (call after mmcReset()).
+/// The device size is taken from mmcGetCapacity().
+void mmcBlockDevInit(BlockDev* dev);
+
 //! Internal command function.
 /// Issues a generic MMC command as specified by cmd and arg.
 u08 mmcCommand(u08 cmd, u32 arg);
@@ -0,0 +1,160 @@
+/*! \file prof.c \brief PC-Sampling Profiler. */
+//*****************************************************************************
+//
+// File Name	: 'prof.c'
+// Title		: PC-Sampling Profiler
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "global.h"
+#include "rprintf.h"
+#include "prof.h"
+
+// global variables
+static u16 ProfHist[PROF_BUCKETS];		// sample counts per address range
+static volatile u32 ProfSamples;		// total samples
+static volatile u16 ProfOutside;		// samples beyond the last bucket
+static u16 ProfPeriod;					// sample period in timer1 tics
+volatile u16 ProfPc;					// last sampled program (word) address
+
+// functions
+
+void profInit(void)
+{
+	profStop();
+	profClear();
+}
+
+void profStart(u16 period)
+{
+	u08 sreg = SREG;
+	cli();
+	ProfPeriod = period;
+	// first sample one period from now
+	OCR1A = TCNT1 + period;
+	// clear any old match and enable the interrupt
+	outb(TIFR, BV(OCF1A));
+	sbi(TIMSK, OCIE1A);
+	SREG = sreg;
+}
+
+void profStop(void)
+{
+	cbi(TIMSK, OCIE1A);
+}
+
+void profClear(void)
+{
+	u08 i;
+	u08 sreg = SREG;
+	cli();
+	for(i=0; i<PROF_BUCKETS; i++)
+		ProfHist[i] = 0;
+	ProfSamples = 0;
+	ProfOutside = 0;
+	SREG = sreg;
+}
+
+u32 profGetSamples(void)
+{
+	u32 samples;
+	u08 sreg = SREG;
+	cli();
+	samples = ProfSamples;
+	SREG = sreg;
+	return samples;
+}
+
+void profDump(void)
+{
+	u08 i;
+	u16 count;
+	u32 addr;
+
+	rprintfProgStrM("addr     end      samples\r\n");
+	for(i=0; i<PROF_BUCKETS; i++)
+	{
+		cli();
+		count = ProfHist[i];
+		sei();
+		if(!count)
+			continue;
+		// buckets hold word addresses, print byte addresses
+		addr = ((u32)i << PROF_BUCKET_SHIFT) << 1;
+		rprintfu32(addr);
+		rprintfChar(' ');
+		rprintfu32(addr + (2UL << PROF_BUCKET_SHIFT) - 1);
+		rprintfChar(' ');
+		rprintfNum(10, 6, FALSE, ' ', count);
+		rprintfCRLF();
+	}
+	rprintfProgStrM("outside: ");
+	rprintfNum(10, 6, FALSE, ' ', ProfOutside);
+	rprintfProgStrM("  total: ");
+	rprintfNum(10, 10, FALSE, ' ', profGetSamples());
+	rprintfCRLF();
+}
+
+// The compare interrupt must read the return address before any
+// registers are pushed, so it starts with a few lines of assembly that
+// save the interrupted PC to ProfPc and then jump to an ordinary
+// interrupt handler to do the rest in C.  None of the instructions
+// used change SREG.  (The handler's name starts with __vector so the
+// compiler accepts it as an interrupt handler.)
+void __vector_prof_sample(void) __attribute__ ((signal));
+void __vector_prof_sample(void)
+{
+	u16 bucket;
+
+	// schedule the next sample
+	OCR1A += ProfPeriod;
+
+	// count the sample
+	ProfSamples++;
+	bucket = ProfPc >> PROF_BUCKET_SHIFT;
+	if(bucket < PROF_BUCKETS)
+	{
+		// saturate rather than wrap
+		if(ProfHist[bucket] != 0xFFFF)
+			ProfHist[bucket]++;
+	}
+	else if(ProfOutside != 0xFFFF)
+		ProfOutside++;
+}
+
+void SIG_OUTPUT_COMPARE1A(void) __attribute__ ((signal, naked));
+void SIG_OUTPUT_COMPARE1A(void)
+{
+	asm volatile (
+		"push r0"					"\n\t"
+		"push r30"					"\n\t"
+		"push r31"					"\n\t"
+		// Z = SP: return address is at SP+4 (high) and SP+5 (low)
+		"in r30, __SP_L__"			"\n\t"
+		"in r31, __SP_H__"			"\n\t"
+		"ldd r0, Z+4"				"\n\t"
+		"sts ProfPc+1, r0"			"\n\t"
+		"ldd r0, Z+5"				"\n\t"
+		"sts ProfPc, r0"			"\n\t"
+		"pop r31"					"\n\t"
+		"pop r30"					"\n\t"
+		"pop r0"					"\n\t"
+#if FLASHEND > 0x1FFF
+		"jmp __vector_prof_sample"	"\n\t"
+#else
+		"rjmp __vector_prof_sample"	"\n\t"
+#endif
+		::);
+}
@@ -0,0 +1,79 @@
+/*! \file prof.h \brief PC-Sampling Profiler. */
+//*****************************************************************************
+//
+// File Name	: 'prof.h'
+// Title		: PC-Sampling Profiler
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+///	\ingroup general
+/// \defgroup prof PC-Sampling Profiler (prof.c)
+/// \code #include "prof.h" \endcode
+/// \par Overview
+///		A statistical profiler that needs no debug hardware.  A timer1
+///		output-compare A interrupt fires at a fixed rate and records the
+///		program address it interrupted in a histogram of flash address
+///		ranges.  After running the code of interest under real load, the
+///		histogram shows where the processor spends its time: main loop,
+///		library code, and other interrupt handlers (when they re-enable
+///		interrupts; otherwise their time shows up at the instruction they
+///		return to).
+///	\par
+///		profDump() prints the non-empty buckets as
+///		"<start byte address> <end byte address> <samples>" lines, which can be
+///		matched to function names with the symbol table of the .elf
+///		(e.g. \c avr-nm \c -n \c smartAlarm.elf).  It takes no arguments, so it
+///		can be registered directly as a cmdline command.
+///	\par
+///		Timer1 must be running (timerInit()).  The profiler steps OCR1A
+///		forward on each sample and does not disturb TCNT1, so timer1 can
+///		still be used for other things, but not its compare A interrupt.
+///		Define PROFILER in your project's global.h so that the timer library
+///		leaves the compare A interrupt vector to the profiler.
+///	\code
+/// profInit();
+/// profStart(187);				// sample about every 1ms (12MHz, timer1 at clk/64)
+/// cmdlineAddCommand("prof", profDump);
+/// \endcode
+///	\note Program addresses above 128K are not supported.
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+//@{
+
+#ifndef PROF_H
+#define PROF_H
+
+#include "global.h"
+
+// include project-dependent configuration options
+#include "profconf.h"
+
+// functions
+
+//! Initializes the profiler and clears the histogram.
+void profInit(void);
+
+//! Starts sampling every \c period timer1 tics.
+void profStart(u16 period);
+
+//! Stops sampling.
+void profStop(void);
+
+//! Clears the histogram.
+void profClear(void);
+
+//! Prints the histogram with rprintf.
+void profDump(void);
+
+//! Returns the number of samples taken since the last clear.
+u32 profGetSamples(void);
+
+#endif
+//@}
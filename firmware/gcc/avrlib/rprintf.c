@@ -36,6 +36,8 @@
 
 #ifdef RPRINTF_COMPLEX
 	static unsigned char buf[128];
+	unsigned char Isdigit(char c);
+	int atoiRamRom(unsigned char stringInRom, char *str);
 #endif
 
 // use this to store hex conversion in RAM
@@ -49,6 +51,13 @@ static char __attribute__ ((progmem)) HexChars[] = "0123456789ABCDEF";
 
 // function pointer to single character output routine
 static void (*rputchar)(unsigned char c);
+// output stream (when initialized with rprintfInitStream)
+static Stream* rstream;
+// memory buffer output (between rprintfBufferBegin and rprintfBufferEnd)
+static void (*rbufSavedPutchar)(unsigned char c);
+static char* rbufPtr;
+static unsigned int rbufSize;
+static unsigned int rbufCount;
 
 // *** rprintf initialization ***
 // you must call this function once and supply the character output
@@ -58,6 +67,58 @@ void rprintfInit(void (*putchar_func)(unsigned char c))
 	rputchar = putchar_func;
 }
 
+// character output routine for stream output
+static void rprintfStreamPutchar(unsigned char c)
+{
+	streamWrite(rstream, c);
+}
+
+// *** rprintf initialization for stream output ***
+void rprintfInitStream(Stream* stream)
+{
+	rstream = stream;
+	rputchar = rprintfStreamPutchar;
+}
+
+// character output routine for memory buffer output
+static void rprintfBufferPutchar(unsigned char c)
+{
+	// store while there is room for the null-terminator,
+	// but keep counting so truncation can be reported
+	// (rbufCount+1 would wrap once the count saturates)
+	if(rbufSize && (rbufCount < rbufSize-1))
+		rbufPtr[rbufCount] = c;
+	if(rbufCount != 0xFFFF)
+		rbufCount++;
+}
+
+// *** rprintfBufferBegin ***
+// redirect output to a memory buffer of <size> bytes
+void rprintfBufferBegin(char* buffer, unsigned int size)
+{
+	rbufSavedPutchar = rputchar;
+	rbufPtr = buffer;
+	rbufSize = size;
+	rbufCount = 0;
+	rputchar = rprintfBufferPutchar;
+}
+
+// *** rprintfBufferEnd ***
+// terminate the buffer, restore the previous output
+// and return the length the output needed
+unsigned int rprintfBufferEnd(void)
+{
+	if(rbufSize)
+	{
+		if(rbufCount < rbufSize)
+			rbufPtr[rbufCount] = 0;
+		else
+			rbufPtr[rbufSize-1] = 0;
+	}
+	rputchar = rbufSavedPutchar;
+	return rbufCount;
+}
+
 // *** rprintfChar ***
 // send a character/byte to the current output device
 void rprintfChar(unsigned char c)
@@ -179,6 +240,59 @@ void rprintfu32(unsigned long data)
 	rprintfu16(data);
 }
 
+// *** rprintfDivMod10 ***
+// divides *x by 10 and returns the remainder
+// the AVR has no hardware divider, and a 32-bit library divide costs
+// several hundred cycles per digit, so do it with shifts and adds:
+// q approximates x*0.8 and is then shifted down to x/10, and may end
+// up one short, which the remainder check corrects
+static unsigned char rprintfDivMod10(unsigned long* x)
+{
+	unsigned long n = *x;
+	unsigned long q, r;
+
+	q = (n >> 1) + (n >> 2);
+	q += q >> 4;
+	q += q >> 8;
+	q += q >> 16;
+	q >>= 3;
+	r = n - ((q << 3) + (q << 1));
+	if(r > 9)
+	{
+		q++;
+		r -= 10;
+	}
+	*x = q;
+	return r;
+}
+
+// *** rprintfDivMod ***
+// divides *x by base and returns the remainder
+// decimal and power-of-two bases avoid the library divide
+static unsigned char rprintfDivMod(unsigned long* x, unsigned char base)
+{
+	unsigned char r;
+
+	switch(base)
+	{
+	case 10:
+		return rprintfDivMod10(x);
+	case 16:
+		r = *x & 0x0F; *x >>= 4;
+		break;
+	case 8:
+		r = *x & 0x07; *x >>= 3;
+		break;
+	case 2:
+		r = *x & 0x01; *x >>= 1;
+		break;
+	default:
+		r = *x % base; *x /= base;
+		break;
+	}
+	return r;
+}
+
 // *** rprintfNum ***
 // special printf for numbers only
 // see formatting information below
@@ -216,14 +330,14 @@ void rprintfNum(char base, char numDigits, char isSigned, char padchar, long n)
 	
 	// force calculation of first digit
 	// (to prevent zero from not printing at all!!!)
-	*--p = hexchar(x%base); x /= base;
+	*--p = hexchar(rprintfDivMod(&x, base));
 	// calculate remaining digits
 	while(count--)
 	{
 		if(x != 0)
 		{
 			// calculate next digit
-			*--p = hexchar(x%base); x /= base;
+			*--p = hexchar(rprintfDivMod(&x, base));
 		}
 		else
 		{
@@ -257,56 +371,235 @@ void rprintfNum(char base, char numDigits, char isSigned, char padchar, long n)
 	}
 }
 
-#ifdef RPRINTF_FLOAT
-// *** rprintfFloat ***
-// floating-point print
-void rprintfFloat(char numDigits, double x)
+#ifdef RPRINTF_TYPED
+// *** rprintfDivMod10u16 ***
+// 16-bit version of rprintfDivMod10
+static unsigned char rprintfDivMod10u16(unsigned short* x)
 {
-	unsigned char firstplace = FALSE;
-	unsigned char negative;
-	unsigned char i, digit;
-	double place = 1.0;
-	
-	// save sign
-	negative = (x<0);
-	// convert to absolute value
-	x = (x>0)?(x):(-x);
-	
-	// find starting digit place
-	for(i=0; i<15; i++)
+	unsigned short n = *x;
+	unsigned short q, r;
+
+	q = (n >> 1) + (n >> 2);
+	q += q >> 4;
+	q += q >> 8;
+	q >>= 3;
+	r = n - ((q << 3) + (q << 1));
+	if(r > 9)
 	{
-		if((x/place) < 10.0)
-			break;
-		else
-			place *= 10.0;
+		q++;
+		r -= 10;
 	}
-	// print polarity character
-	if(negative)
+	*x = q;
+	return r;
+}
+
+// *** rprintfDecU16 ***
+// prints an unsigned 16-bit number in decimal, no padding
+void rprintfDecU16(unsigned short n)
+{
+	char *p, buf[5];
+
+	p = buf + sizeof(buf);
+	do {
+		*--p = rprintfDivMod10u16(&n) + '0';
+	} while(n);
+	while(p < buf + sizeof(buf))
+		rprintfChar(*p++);
+}
+
+// *** rprintfDecS16 ***
+// prints a signed 16-bit number in decimal, no padding
+void rprintfDecS16(short n)
+{
+	if(n < 0)
+	{
 		rprintfChar('-');
+		rprintfDecU16(-(unsigned short)n);
+	}
 	else
-		rprintfChar('+');
+		rprintfDecU16(n);
+}
+
+// *** rprintfDecU32 ***
+// prints an unsigned 32-bit number in decimal, no padding
+void rprintfDecU32(unsigned long n)
+{
+	char *p, buf[10];
+
+	p = buf + sizeof(buf);
+	do {
+		*--p = rprintfDivMod10(&n) + '0';
+	} while(n);
+	while(p < buf + sizeof(buf))
+		rprintfChar(*p++);
+}
 
-	// print digits
-	for(i=0; i<numDigits; i++)
+// *** rprintfDecS32 ***
+// prints a signed 32-bit number in decimal, no padding
+void rprintfDecS32(long n)
+{
+	if(n < 0)
 	{
-		digit = (x/place);
+		rprintfChar('-');
+		rprintfDecU32(-(unsigned long)n);
+	}
+	else
+		rprintfDecU32(n);
+}
+#endif
 
-		if(digit | firstplace | (place == 1.0))
-		{
-			firstplace = TRUE;
-			rprintfChar(digit+0x30);
-		}
-		else
-			rprintfChar(' ');
-		
-		if(place == 1.0)
-		{
-			rprintfChar('.');
-		}
-		
-		x -= (digit*place);
-		place /= 10.0;
+#if defined(RPRINTF_FIXED) || defined(RPRINTF_FLOAT)
+// *** rprintfFixedParts ***
+// prints <sign><ip>.<frac>, with <frac> zero-padded to <decimals> digits
+// and the part before the point right-justified to at least <width> places
+static void rprintfFixedParts(char width, char decimals, char sign, unsigned long ip, unsigned long frac)
+{
+	char *p, buf[12];
+	int pad;
+
+	// integer part, always at least one digit
+	p = buf + sizeof(buf);
+	do {
+		*--p = rprintfDivMod10(&ip) + '0';
+	} while(ip);
+	if(sign)
+		*--p = sign;
+
+	// pad and print
+	pad = width - ((buf + sizeof(buf)) - p);
+	while(pad-- > 0)
+		rprintfChar(' ');
+	while(p < buf + sizeof(buf))
+		rprintfChar(*p++);
+
+	// fraction
+	if(decimals)
+	{
+		rprintfChar('.');
+		rprintfNum(10, decimals, FALSE, '0', frac);
+	}
+}
+
+// *** rprintfScaled ***
+// prints an unsigned integer scaled by 10^decimals
+static void rprintfScaled(char width, char decimals, char sign, unsigned long u)
+{
+	unsigned long frac = 0, scale = 1;
+	unsigned char i;
+
+	// peel off the fraction digits
+	for(i=0; i<decimals; i++)
+	{
+		frac += rprintfDivMod10(&u) * scale;
+		scale = (scale << 3) + (scale << 1);
+	}
+	rprintfFixedParts(width, decimals, sign, u, frac);
+}
+#endif
+
+#ifdef RPRINTF_FIXED
+// *** rprintfFixed ***
+// prints a binary fixed-point number (n / 2^fracBits), rounded to nearest
+void rprintfFixed(char width, char decimals, unsigned char fracBits, long n)
+{
+	unsigned long u, ip, frac, scale;
+	unsigned char i;
+	char sign = 0;
+
+	// prepare negative number
+	if(n < 0)
+	{
+		sign = '-';
+		u = -(unsigned long)n;
+	}
+	else
+		u = n;
+
+	// split into integer and fraction parts
+	if(fracBits > 31)
+		fracBits = 31;
+	ip = u >> fracBits;
+	frac = u & ((1UL << fracBits) - 1);
+	if(decimals > RPRINTF_FIXED_MAXDECIMALS)
+		decimals = RPRINTF_FIXED_MAXDECIMALS;
+
+	// scale the fraction to decimal places, rounding half up
+	scale = 1;
+	for(i=0; i<decimals; i++)
+		scale = (scale << 3) + (scale << 1);
+	if(fracBits > 16)
+	{
+		// frac * scale would not fit in 32 bits: multiply the high and
+		// low 16 bits separately, keeping the bits the rounding needs
+		i = fracBits - 16;
+		frac = ((frac >> 16) * scale + (1UL << (i-1)) + (((frac & 0xFFFF) * scale) >> 16)) >> i;
 	}
+	else if(fracBits)
+		frac = (frac*scale + (1UL << (fracBits-1))) >> fracBits;
+	// rounding may carry into the integer part
+	if(frac >= scale)
+	{
+		ip++;
+		frac -= scale;
+	}
+	// don't print "-0.00"
+	if(!ip && !frac)
+		sign = 0;
+
+	rprintfFixedParts(width, decimals, sign, ip, frac);
+}
+
+// *** rprintfDecimal ***
+// prints a scaled integer (n / 10^decimals)
+void rprintfDecimal(char width, char decimals, long n)
+{
+	if(decimals > 9)
+		decimals = 9;
+	if(n < 0)
+		rprintfScaled(width, decimals, '-', -(unsigned long)n);
+	else
+		rprintfScaled(width, decimals, 0, n);
+}
+#endif
+
+#ifdef RPRINTF_FLOAT
+// *** rprintfFloat ***
+// floating-point print
+// the value is converted to a scaled integer once and then printed with
+// integer arithmetic, so only a multiply, an add and the conversions
+// are pulled in from the floating-point library
+void rprintfFloat(char numDigits, double x)
+{
+	unsigned long ip, scale;
+	unsigned char i, intDigits, decimals;
+	char sign;
+
+	// save sign, convert to absolute value
+	sign = (x < 0)?('-'):('+');
+	x = (x > 0)?(x):(-x);
+	// clamp to the range of an unsigned long
+	if(x > 4294967295.0)
+		x = 4294967295.0;
+
+	// count digits before the point (at least one)
+	ip = x;
+	intDigits = 0;
+	do {
+		rprintfDivMod10(&ip);
+		intDigits++;
+	} while(ip);
+
+	// the remaining digits go behind the point, but keep the
+	// total within 9 digits so the scaled value fits in 32 bits
+	if(numDigits > 9)
+		numDigits = 9;
+	decimals = (numDigits > intDigits)?(numDigits - intDigits):(0);
+	scale = 1;
+	for(i=0; i<decimals; i++)
+		scale = (scale << 3) + (scale << 1);
+
+	// convert once, rounding to nearest
+	rprintfScaled(0, decimals, sign, (unsigned long)(x*scale + 0.5));
 }
 #endif
 
@@ -388,7 +681,7 @@ int rprintf2RamRom(unsigned char stringInRom, const char *sfmt, ...)
 {
 	register unsigned char *f, *bp;
 	register long l;
-	register unsigned long u;
+	unsigned long u;
 	register int i;
 	register int fmt;
 	register unsigned char pad = ' ';
@@ -470,11 +763,13 @@ int rprintf2RamRom(unsigned char stringInRom, const char *sfmt, ...)
 					if (l < 0)
 					{
 						sign = 1;
-						l = -l;
+						u = -(unsigned long)l;
 					}
+					else
+						u = l;
 					do	{
-						*bp++ = l % 10 + '0';
-					} while ((l /= 10) > 0);
+						*bp++ = rprintfDivMod10(&u) + '0';
+					} while (u > 0);
 					if (sign)
 						*bp++ = '-';
 					f_width = f_width - (bp - buf);
@@ -497,26 +792,26 @@ int rprintf2RamRom(unsigned char stringInRom, const char *sfmt, ...)
 					if (fmt == 'u')
 					{	// unsigned decimal
 						do {
-							*bp++ = u % 10 + '0';
-						} while ((u /= 10) > 0);
+							*bp++ = rprintfDivMod10(&u) + '0';
+						} while (u > 0);
 					}
 					else if (fmt == 'o')
 					{  // octal
 						do {
-							*bp++ = u % 8 + '0';
-						} while ((u /= 8) > 0);
+							*bp++ = (u & 0x07) + '0';
+						} while ((u >>= 3) > 0);
 						if (hash)
 							*bp++ = '0';
 					}
 					else if (fmt == 'x')
 					{	// hex
 						do {
-							i = u % 16;
+							i = u & 0x0F;
 							if (i < 10)
 								*bp++ = i + '0';
 							else
 								*bp++ = i - 10 + 'a';
-						} while ((u /= 16) > 0);
+						} while ((u >>= 4) > 0);
 						if (hash)
 						{
 							*bp++ = 'x';
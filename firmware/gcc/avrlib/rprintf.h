@@ -43,6 +43,7 @@
 
 // needed for use of PSTR below
 #include <avr/pgmspace.h>
+#include "stream.h"
 
 // configuration
 // defining RPRINTF_SIMPLE will compile a smaller, simpler, and faster printf() function
@@ -52,7 +53,17 @@
 #endif
 
 // Define RPRINTF_FLOAT to enable the floating-point printf function: rprintfFloat()
-// (adds +4600bytes or 2.2Kwords of code)
+// (pulls in the floating-point multiply and int conversions)
+
+// Define RPRINTF_TYPED to enable type-checked printing without format strings: rprintfT()
+
+// Define RPRINTF_FIXED to enable the fixed-point print functions:
+// rprintfFixed() and rprintfDecimal() (no floating-point code needed)
+#ifndef RPRINTF_FIXED_MAXDECIMALS
+//! Maximum number of decimal places printed by rprintfFixed()
+/// (4 is the most that keeps the rounding exact in 32 bits)
+#define RPRINTF_FIXED_MAXDECIMALS	4
+#endif
 
 // defines/constants
 #define STRING_IN_RAM	0
@@ -68,6 +79,33 @@
 /// The argument must be a character stream output function.
 void rprintfInit(void (*putchar_func)(unsigned char c));
 
+//! Initializes the rprintf library to print to a byte-stream.
+/// Use this instead of rprintfInit() to have output counted
+/// in the stream's statistics.
+void rprintfInitStream(Stream* stream);
+
+//! Redirects rprintf output into a memory buffer.
+/// All output up to the matching rprintfBufferEnd() is stored in \c buffer
+/// instead of being sent to the output device, so that a packet, LCD line
+/// or log record can be composed in place and sent as a single block.
+/// At most size-1 characters are stored; the rest are counted but dropped.
+/// \code
+/// char line[17];
+/// rprintfBufferBegin(line, sizeof(line));
+/// rprintf("T=%d", temp);
+/// if(rprintfBufferEnd() >= sizeof(line))
+///		...output was truncated...
+/// \endcode
+/// \note Buffered output cannot be nested.
+void rprintfBufferBegin(char* buffer, unsigned int size);
+
+//! Ends buffered output started with rprintfBufferBegin().
+/// Null-terminates the buffer and restores the previous output device.
+/// Returns the number of characters the output needed, not counting the
+/// null-terminator (like snprintf).  A value of \c size or more means the
+/// output was truncated.
+unsigned int rprintfBufferEnd(void);
+
 //! prints a single character to the current output device
 void rprintfChar(unsigned char c);
 
@@ -118,9 +156,86 @@ void rprintfNum(char base, char numDigits, char isSigned, char padchar, long n);
 
 #ifdef RPRINTF_FLOAT
 	//! floating-point print routine
+	/// Prints a sign and \c numDigits significant digits (at most 9),
+	/// rounded to nearest.  The value is converted to an integer once,
+	/// so values beyond +/-4294967295 are clamped.
 	void rprintfFloat(char numDigits, double x);
 #endif
 
+#ifdef RPRINTF_FIXED
+	//! fixed-point print routine
+	/// Prints the binary fixed-point number n/2^fracBits (fracBits 0-31,
+	/// larger values are taken as 31),
+	/// rounded to nearest with \c decimals places after the point (at most
+	/// RPRINTF_FIXED_MAXDECIMALS).  The sign and integer part are
+	/// right-justified to at least \c width characters.  For Q16.16
+	/// values, or numbers from the fixedpt library, pass the same number
+	/// of bits given to fixedptInit().
+	/// \code
+	/// rprintfFixed(4, 2, 16, 0x00028000);		-->  "   2.50"
+	/// rprintfFixed(0, 3, 8, -0x0180);			-->  "-1.500"
+	/// \endcode
+	void rprintfFixed(char width, char decimals, unsigned char fracBits, long n);
+
+	//! scaled-integer print routine
+	/// Prints n/10^decimals, such as millivolts as volts
+	/// (\c decimals is at most 9).
+	/// \code
+	/// rprintfDecimal(6, 3, 12345);	-->  "    12.345"
+	/// rprintfDecimal(0, 1, -5);		-->  "-0.5"
+	/// \endcode
+	void rprintfDecimal(char width, char decimals, long n);
+#endif
+
+#ifdef RPRINTF_TYPED
+	// Type-checked printing without a format string.
+	//
+	// rprintfT() takes a list of items, each of which expands at compile
+	// time to a direct call of the print routine for its argument's type.
+	// Nothing is parsed at run-time, no varargs are used, and passing the
+	// wrong kind of value (a pointer or float to rpDec(), a number to
+	// rpRam(), a variable to rpStr()) stops the build with an error like
+	// "size of array is negative" or "expected ')' before 's'".
+	//
+	// rprintfT(rpStr("adc ch"), rpDec(ch), rpStr(" = 0x"), rpHex(val), rpCRLF());
+
+	//! prints a sequence of rp...() items
+	#define rprintfT(items...)	((void)(items))
+
+	// compile-time checks
+	#define RPRINTF_ASSERT(cond)	((void)sizeof(char[1 - 2*!(cond)]))
+	// integer, enum or bool (gcc type classes 1, 3 and 4)
+	#define RPRINTF_IS_INT(x)		((__builtin_classify_type(x) == 1) || \
+									 (__builtin_classify_type(x) == 3) || \
+									 (__builtin_classify_type(x) == 4))
+	#define RPRINTF_IS_SIGNED(x)	((typeof(x))-1 < 1)
+
+	//! item: string literal (stored in program memory)
+	#define rpStr(s)	rprintfProgStr(PSTR("" s))
+	//! item: null-terminated string in RAM
+	#define rpRam(s)	(RPRINTF_ASSERT(__builtin_types_compatible_p(typeof((s)[0]), char) || \
+									__builtin_types_compatible_p(typeof((s)[0]), unsigned char)), \
+						rprintfStr((char*)(s)))
+	//! item: single character
+	#define rpChar(c)	(RPRINTF_ASSERT(RPRINTF_IS_INT(c)), rprintfChar(c))
+	//! item: integer in decimal, signed or unsigned by the argument's type
+	#define rpDec(x)	(RPRINTF_ASSERT(RPRINTF_IS_INT(x) && (sizeof(x) <= 4)), \
+						__builtin_choose_expr(sizeof(x) > 2, \
+							__builtin_choose_expr(RPRINTF_IS_SIGNED(x), rprintfDecS32(x), rprintfDecU32(x)), \
+							__builtin_choose_expr(RPRINTF_IS_SIGNED(x), rprintfDecS16(x), rprintfDecU16(x))))
+	//! item: integer in hex, 2, 4 or 8 digits by the argument's size
+	#define rpHex(x)	(RPRINTF_ASSERT(RPRINTF_IS_INT(x) && (sizeof(x) <= 4)), \
+						__builtin_choose_expr(sizeof(x) == 1, rprintfu08(x), \
+						__builtin_choose_expr(sizeof(x) == 2, rprintfu16(x), rprintfu32(x))))
+	//! item: carriage-return and line-feed
+	#define rpCRLF()	rprintfCRLF()
+
+	void rprintfDecU16(unsigned short n);	///< Print unsigned 16-bit number in decimal.
+	void rprintfDecS16(short n);			///< Print signed 16-bit number in decimal.
+	void rprintfDecU32(unsigned long n);	///< Print unsigned 32-bit number in decimal.
+	void rprintfDecS32(long n);				///< Print signed 32-bit number in decimal.
+#endif
+
 // NOTE: Below you'll see the function prototypes of rprintf1RamRom and 
 // rprintf2RamRom.  rprintf1RamRom and rprintf2RamRom are both reduced versions
 // of the regular C printf() command.  However, they are modified to be able
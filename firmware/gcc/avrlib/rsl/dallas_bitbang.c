@@ -50,19 +50,9 @@ u08 dallas_crc_table[] =		// dallas crc lookup table
  *-------------------------------------------------------------------------*/
 u08 dallasFindNextDevice(dallas_rom_id_T* rom_id);
 
-void dallasDelayUs(u16 us)
-{
-	while(us--) // 6 cycles
-	{
-		asm volatile ("nop");
-		asm volatile ("nop");
-		asm volatile ("nop");
-		asm volatile ("nop");
-		asm volatile ("nop");
-		asm volatile ("nop");
-		asm volatile ("nop");
-	} // loop jump 2 cycles
-}
+// 1-Wire timing delays
+// (all delays are constants, so these compile to cycle-counted loops for F_CPU)
+#define dallasDelayUs(us)	delay_us(us)
 
 void dallasInit(void)
 {
@@ -0,0 +1,213 @@
+/*! \file seccache.c \brief Write-back sector cache for block devices. */
+//*****************************************************************************
+//
+// File Name	: 'seccache.c'
+// Title		: Write-back sector cache for block devices
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include "global.h"
+#include "seccache.h"
+
+// entry flags
+#define SECCACHE_VALID		0x01
+#define SECCACHE_DIRTY		0x02
+
+// cache entry state
+typedef struct
+{
+	BlockDev* dev;			// device the sector belongs to
+	u32 sector;				// sector number
+	u16 used;				// use stamp for LRU replacement
+	u08 flags;				// SECCACHE_VALID, SECCACHE_DIRTY
+} SecCacheEntry;
+
+// global variables
+static SecCacheEntry SecCache[SECCACHE_ENTRIES];
+static u16 SecCacheTick;
+static SecCacheStats SecCacheStat;
+
+// sector buffers
+#ifdef SECCACHE_BUFFER_ADDR
+#define seccacheBuffer(i)	((u08*)(SECCACHE_BUFFER_ADDR) + ((u16)(i)<<9))
+#else
+static u08 SecCacheBuffer[SECCACHE_ENTRIES][BLOCKDEV_BLOCKSIZE];
+#define seccacheBuffer(i)	(SecCacheBuffer[i])
+#endif
+
+// make an entry the most recently used
+static void seccacheTouch(u08 i)
+{
+	u08 j;
+
+	if(++SecCacheTick == 0)
+	{
+		// stamp wrapped: restart the ages (the order is lost once)
+		for(j=0; j<SECCACHE_ENTRIES; j++)
+			SecCache[j].used = 0;
+		SecCacheTick = 1;
+	}
+	SecCache[i].used = SecCacheTick;
+}
+
+// write back an entry if it is dirty
+static u08 seccacheClean(u08 i)
+{
+	if(SecCache[i].flags & SECCACHE_DIRTY)
+	{
+		if(blockdevWrite(SecCache[i].dev, SecCache[i].sector, 1, seccacheBuffer(i)))
+		{
+			SecCacheStat.errors++;
+			return 1;
+		}
+		SecCache[i].flags &= ~SECCACHE_DIRTY;
+		SecCacheStat.writebacks++;
+	}
+	return 0;
+}
+
+// find the entry holding a sector, or free the least recently used entry
+// for it (returns SECCACHE_ENTRIES if that fails)
+static u08 seccacheLookup(BlockDev* dev, u32 sector, u08* hit)
+{
+	u08 i, victim = 0;
+
+	for(i=0; i<SECCACHE_ENTRIES; i++)
+	{
+		if((SecCache[i].flags & SECCACHE_VALID) &&
+			(SecCache[i].dev == dev) && (SecCache[i].sector == sector))
+		{
+			SecCacheStat.hits++;
+			*hit = TRUE;
+			seccacheTouch(i);
+			return i;
+		}
+		// prefer an empty entry, then the oldest
+		if(!(SecCache[i].flags & SECCACHE_VALID))
+			victim = i;
+		else if((SecCache[victim].flags & SECCACHE_VALID) && (SecCache[i].used < SecCache[victim].used))
+			victim = i;
+	}
+
+	SecCacheStat.misses++;
+	*hit = FALSE;
+	if(seccacheClean(victim))
+		return SECCACHE_ENTRIES;
+	SecCache[victim].flags = 0;
+	SecCache[victim].dev = dev;
+	SecCache[victim].sector = sector;
+	seccacheTouch(victim);
+	return victim;
+}
+
+void seccacheInit(void)
+{
+	seccacheInvalidate(0);
+	SecCacheTick = 0;
+	seccacheClearStats();
+}
+
+u08* seccacheRead(BlockDev* dev, u32 sector)
+{
+	u08 i, hit;
+
+	if((i = seccacheLookup(dev, sector, &hit)) == SECCACHE_ENTRIES)
+		return 0;
+	if(!hit)
+	{
+		if(blockdevRead(dev, sector, 1, seccacheBuffer(i)))
+		{
+			SecCacheStat.errors++;
+			return 0;
+		}
+		SecCache[i].flags = SECCACHE_VALID;
+	}
+	return seccacheBuffer(i);
+}
+
+u08* seccacheGetNew(BlockDev* dev, u32 sector)
+{
+	u08 i, hit;
+
+	if((i = seccacheLookup(dev, sector, &hit)) == SECCACHE_ENTRIES)
+		return 0;
+	SecCache[i].flags = SECCACHE_VALID | SECCACHE_DIRTY;
+	return seccacheBuffer(i);
+}
+
+// find the entry of a buffer returned by the cache
+static u08 seccacheEntry(u08* buffer)
+{
+	u08 i;
+
+	for(i=0; i<SECCACHE_ENTRIES; i++)
+	{
+		if(buffer == seccacheBuffer(i))
+			break;
+	}
+	return i;
+}
+
+void seccacheMarkDirty(u08* buffer)
+{
+	u08 i;
+
+	if((i = seccacheEntry(buffer)) < SECCACHE_ENTRIES)
+		SecCache[i].flags |= SECCACHE_DIRTY;
+}
+
+u08 seccacheFlush(u08* buffer)
+{
+	u08 i;
+
+	if((i = seccacheEntry(buffer)) < SECCACHE_ENTRIES)
+		return seccacheClean(i);
+	return 0;
+}
+
+u08 seccacheSync(BlockDev* dev)
+{
+	u08 i, result = 0;
+
+	for(i=0; i<SECCACHE_ENTRIES; i++)
+	{
+		if((SecCache[i].flags & SECCACHE_VALID) && (!dev || SecCache[i].dev == dev))
+			result |= seccacheClean(i);
+	}
+	if(dev)
+		result |= blockdevSync(dev);
+	return result;
+}
+
+void seccacheInvalidate(BlockDev* dev)
+{
+	u08 i;
+
+	for(i=0; i<SECCACHE_ENTRIES; i++)
+	{
+		if(!dev || SecCache[i].dev == dev)
+			SecCache[i].flags = 0;
+	}
+}
+
+SecCacheStats* seccacheGetStats(void)
+{
+	return &SecCacheStat;
+}
+
+void seccacheClearStats(void)
+{
+	SecCacheStat.hits = 0;
+	SecCacheStat.misses = 0;
+	SecCacheStat.writebacks = 0;
+	SecCacheStat.errors = 0;
+}
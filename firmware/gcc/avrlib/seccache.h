@@ -0,0 +1,107 @@
+/*! \file seccache.h \brief Write-back sector cache for block devices. */
+//*****************************************************************************
+//
+// File Name	: 'seccache.h'
+// Title		: Write-back sector cache for block devices
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+///	\ingroup general
+/// \defgroup seccache Sector Cache (seccache.c)
+/// \code #include "seccache.h" \endcode
+/// \par Overview
+///		A small cache of 512-byte sectors shared by all block devices (see
+///		blockdev.h).  Entries are keyed by device and sector number and the
+///		least recently used entry is replaced.  Sectors changed in the cache
+///		are marked dirty and written back when they are replaced or when
+///		seccacheSync() is called.  Hits, misses and write-backs are counted.
+///	\par
+///		The cache holds SECCACHE_ENTRIES sectors (default 2, the minimum).
+///		They are allocated in internal SRAM, or placed at SECCACHE_BUFFER_ADDR
+///		in memory-mapped external RAM if that is defined.  Override either in
+///		your project's global.h.
+///	\code
+/// u08* data;
+///
+/// if((data = seccacheRead(&card, sector)))
+/// {
+/// 	data[0] ^= 1;
+/// 	seccacheMarkDirty(data);
+/// }
+/// seccacheSync(&card);
+/// \endcode
+///	\note A buffer returned by the cache becomes the most recently used
+///		entry, so it stays valid until SECCACHE_ENTRIES-1 other sectors have
+///		been requested.
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+//@{
+
+#ifndef SECCACHE_H
+#define SECCACHE_H
+
+#include "global.h"
+#include "blockdev.h"
+
+#ifndef SECCACHE_ENTRIES
+//! Number of sectors cached (512 bytes of RAM each, plus 8 bytes of state).
+#define SECCACHE_ENTRIES		2
+#endif
+#if SECCACHE_ENTRIES < 2
+#error SECCACHE_ENTRIES must be at least 2
+#endif
+
+//! Cache statistics.
+typedef struct struct_SecCacheStats
+{
+	u32 hits;				///< requests found in the cache
+	u32 misses;				///< requests that had to read the device
+	u32 writebacks;			///< dirty sectors written back
+	u16 errors;				///< failed reads and write-backs
+} SecCacheStats;
+
+// functions
+
+//! Empties the cache, discarding any dirty sectors, and clears the statistics.
+void seccacheInit(void);
+
+//! Returns a cached copy of a sector, reading it from the device if needed.
+/// Returns zero if the sector could not be read (or a dirty sector could
+/// not be written back to make room).
+u08* seccacheRead(BlockDev* dev, u32 sector);
+
+//! Returns a cache buffer for a sector that the caller will overwrite
+/// completely, without reading it from the device.  The buffer is marked
+/// dirty.  Returns zero if no entry could be freed.
+u08* seccacheGetNew(BlockDev* dev, u32 sector);
+
+//! Marks a buffer returned by the cache as changed.
+void seccacheMarkDirty(u08* buffer);
+
+//! Writes back a buffer returned by the cache now, if it is dirty.
+/// Returns zero if successful.
+u08 seccacheFlush(u08* buffer);
+
+//! Writes back the dirty sectors of a device (of all devices if dev is 0)
+/// and syncs the device.  Returns zero if successful.
+u08 seccacheSync(BlockDev* dev);
+
+//! Drops the sectors of a device (of all devices if dev is 0) from the
+/// cache without writing them back, e.g. after a card change.
+void seccacheInvalidate(BlockDev* dev);
+
+//! Returns pointer to the cache statistics.
+SecCacheStats* seccacheGetStats(void);
+
+//! Clears the cache statistics.
+void seccacheClearStats(void);
+
+#endif
+//@}
@@ -0,0 +1,198 @@
+/*! \file slip.c \brief SLIP Framed Packet Transport with CRC-16. */
+//*****************************************************************************
+//
+// File Name	: 'slip.c'
+// Title		: SLIP Framed Packet Transport with CRC-16
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: any
+// Editor Tabs	: 4
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <util/crc16.h>
+
+#include "global.h"
+#include "buffer.h"
+#include "slip.h"
+
+// function pointer to data output routine
+static void (*slipDataOut)(unsigned char data);
+
+// transmit CRC
+static u16 slipTxCrc;
+
+// receive state
+static u16 slipRxCrc;
+static u16 slipRxLength;
+static u08 slipRxEscape;
+static u08 slipRxOverrun;
+static u16 slipRxErrors;
+static u16 slipRxPacketLength;
+
+// received packet data buffer
+unsigned char slipRxPacket[SLIP_MAXRXPACKETSIZE];
+
+// functions
+
+// Initialize SLIP packet transport library
+void slipInit(void (*dataout_func)(unsigned char data))
+{
+	slipDataOut = dataout_func;
+	// reset receiver
+	slipRxCrc = 0xFFFF;
+	slipRxLength = 0;
+	slipRxEscape = FALSE;
+	slipRxOverrun = FALSE;
+	slipRxErrors = 0;
+	slipRxPacketLength = 0;
+}
+
+// send one byte, escaped if necessary, and add it to the CRC
+static void slipSendByte(u08 data)
+{
+	slipTxCrc = _crc_ccitt_update(slipTxCrc, data);
+	if(data == SLIP_END)
+	{
+		slipDataOut(SLIP_ESC);
+		data = SLIP_ESC_END;
+	}
+	else if(data == SLIP_ESC)
+	{
+		slipDataOut(SLIP_ESC);
+		data = SLIP_ESC_ESC;
+	}
+	slipDataOut(data);
+}
+
+void slipSendBegin(u08 type)
+{
+	// a leading END flushes any line noise at the receiver
+	slipDataOut(SLIP_END);
+	slipTxCrc = 0xFFFF;
+	slipSendByte(type);
+}
+
+void slipSendData(u16 datalength, u08* dataptr)
+{
+	while(datalength--)
+		slipSendByte(*dataptr++);
+}
+
+void slipSendBuffer(cBuffer* buffer, u16 datalength)
+{
+	// stream straight out of the buffer, no copy needed
+	while(datalength-- && buffer->datalength)
+		slipSendByte(bufferGetFromFront(buffer));
+}
+
+void slipSendEnd(void)
+{
+	u16 crc = slipTxCrc;
+	// CRC goes low byte first, so the receiver's
+	// CRC over the whole packet comes out to zero
+	slipSendByte(crc);
+	slipSendByte(crc>>8);
+	slipDataOut(SLIP_END);
+}
+
+void slipSend(u08 type, u16 datalength, u08* dataptr)
+{
+	slipSendBegin(type);
+	slipSendData(datalength, dataptr);
+	slipSendEnd();
+}
+
+u08 slipProcess(cBuffer* rxBuffer)
+{
+	u08 c;
+
+	while(rxBuffer->datalength)
+	{
+		c = bufferGetFromFront(rxBuffer);
+
+		if(c == SLIP_END)
+		{
+			// end of packet
+			// (empty packets are just back-to-back END markers)
+			if(slipRxLength)
+			{
+				// need at least a type and the CRC, and a CRC residue of zero
+				if(!slipRxOverrun && (slipRxLength >= 3) && (slipRxCrc == 0))
+				{
+					// we have a packet!
+					slipRxPacketLength = slipRxLength;
+					slipRxCrc = 0xFFFF;
+					slipRxLength = 0;
+					slipRxEscape = FALSE;
+					return TRUE;
+				}
+				slipRxErrors++;
+			}
+			// resynchronize
+			slipRxCrc = 0xFFFF;
+			slipRxLength = 0;
+			slipRxEscape = FALSE;
+			slipRxOverrun = FALSE;
+			continue;
+		}
+
+		if(slipRxEscape)
+		{
+			// second byte of an escape sequence
+			slipRxEscape = FALSE;
+			if(c == SLIP_ESC_END)
+				c = SLIP_END;
+			else if(c == SLIP_ESC_ESC)
+				c = SLIP_ESC;
+			else
+				slipRxOverrun = TRUE;	// protocol violation, drop packet
+		}
+		else if(c == SLIP_ESC)
+		{
+			slipRxEscape = TRUE;
+			continue;
+		}
+
+		// store the byte
+		slipRxCrc = _crc_ccitt_update(slipRxCrc, c);
+		if(slipRxLength < SLIP_MAXRXPACKETSIZE)
+			slipRxPacket[slipRxLength] = c;
+		else
+			slipRxOverrun = TRUE;		// too long, drop packet
+		// keep counting so the packet is not mistaken for empty
+		if(slipRxLength < 0xFFFF)
+			slipRxLength++;
+	}
+
+	return FALSE;
+}
+
+u08 slipGetRxPacketType(void)
+{
+	// return the packet's type
+	return slipRxPacket[0];
+}
+
+u16 slipGetRxPacketDatalength(void)
+{
+	// return the packet's datalength (not counting type and CRC)
+	return slipRxPacketLength-3;
+}
+
+u08* slipGetRxPacketData(void)
+{
+	// return a pointer to the packet's data payload
+	return slipRxPacket+1;
+}
+
+u16 slipGetRxErrors(void)
+{
+	// return the number of discarded packets
+	return slipRxErrors;
+}
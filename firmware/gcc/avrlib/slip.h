@@ -0,0 +1,111 @@
+/*! \file slip.h \brief SLIP Framed Packet Transport with CRC-16. */
+//*****************************************************************************
+//
+// File Name	: 'slip.h'
+// Title		: SLIP Framed Packet Transport with CRC-16
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: any
+// Editor Tabs	: 4
+//
+///	\ingroup general
+/// \defgroup slip SLIP Framed Packet Transport with CRC-16 (slip.c)
+/// \code #include "slip.h" \endcode
+/// \par Overview
+///		This library sends and receives binary packets over any serial byte
+///		stream using SLIP framing (RFC 1055) and a CRC-16 trailer.  Unlike
+///		STX/ETX packets, any byte value may appear in the data and the packet
+///		length is not limited by a length field.  Because the END marker can
+///		never appear inside a packet, the receiver always resynchronizes at
+///		the next END after line noise, and a corrupted packet costs at most
+///		that one packet.
+///	\par
+///		Packets are encoded directly to the output function as they are sent,
+///		and decoded directly out of the serial port's receive buffer, so no
+///		transmit buffer is needed and the receiver only needs room for one
+///		packet (SLIP_MAXRXPACKETSIZE in slipconf.h).
+///	\par
+///		SLIP packets have the following structure:
+///
+///		[END][type][user data...][crc lo][crc hi][END]
+///
+///		The type byte lets several higher level protocols (control, trace
+///		dump, file transfer, ...) share one link.  The CRC is CRC-16/CCITT
+///		(polynomial 0x1021, reflected, initial value 0xFFFF) over the type
+///		and data.  Any END or ESC byte in type, data or CRC is sent as a
+///		two byte escape sequence.
+///	\code
+/// slipInit(uartSendByte);
+/// slipSend(MY_TYPE, sizeof(report), (u08*)&report);
+/// ...
+/// if(slipProcess(uartGetRxBuffer()))
+///		handlePacket(slipGetRxPacketType(), slipGetRxPacketDatalength(), slipGetRxPacketData());
+/// \endcode
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+//@{
+
+#ifndef SLIP_H
+#define SLIP_H
+
+#include "global.h"
+#include "buffer.h"
+
+// include project-dependent configuration options
+#include "slipconf.h"
+
+// constants
+// SLIP special characters
+#define SLIP_END			0xC0	///< packet boundary
+#define SLIP_ESC			0xDB	///< escape
+#define SLIP_ESC_END		0xDC	///< ESC ESC_END means END data byte
+#define SLIP_ESC_ESC		0xDD	///< ESC ESC_ESC means ESC data byte
+
+// function prototypes
+
+//! Initialize SLIP packet transport library
+void slipInit(void (*dataout_func)(unsigned char data));
+
+//! Send a complete SLIP packet
+void slipSend(u08 type, u16 datalength, u08* dataptr);
+
+//! Begin sending a packet in pieces
+/// Use slipSendBegin(), then any number of slipSendData() and
+/// slipSendBuffer() calls, then slipSendEnd().
+void slipSendBegin(u08 type);
+
+//! Send part of the packet data
+void slipSendData(u16 datalength, u08* dataptr);
+
+//! Send part of the packet data directly out of a cBuffer
+/// Removes up to datalength bytes from the front of the buffer.
+void slipSendBuffer(cBuffer* buffer, u16 datalength);
+
+//! Finish sending a packet (sends CRC and END)
+void slipSendEnd(void);
+
+//! Decode packets from a receive buffer
+/// Consumes bytes from the buffer until a valid packet has been decoded
+/// (returns TRUE) or the buffer is empty (returns FALSE).  Decoding state
+/// is kept between calls, so a packet may arrive over several calls.
+u08 slipProcess(cBuffer* rxBuffer);
+
+//! Returns the received packet's type
+u08 slipGetRxPacketType(void);
+
+//! Returns the received packet's datalength
+u16 slipGetRxPacketDatalength(void);
+
+//! Returns pointer to the received packet's data
+u08* slipGetRxPacketData(void);
+
+//! Returns the number of packets discarded for bad CRC or length
+u16 slipGetRxErrors(void);
+
+#endif
+//@}
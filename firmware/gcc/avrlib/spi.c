@@ -23,6 +23,7 @@
 #include <avr/interrupt.h>
 
 #include "spi.h"
+#include "isrstat.h"
 
 // Define the SPI_USEINT key if you want SPI bus operation to be
 // interrupt-driven.  The primary reason for not using SPI in
@@ -41,6 +42,7 @@ volatile u08 spiTransferComplete;
 #ifdef SPI_USEINT
 SIGNAL(SIG_SPI)
 {
+	ISRSTAT_ENTER(ISRSTAT_SPI);
 	spiTransferComplete = TRUE;
 }
 #endif
@@ -77,7 +79,7 @@ void spiInit()
 	// clock = f/4
 //	cbi(SPCR, SPR0);
 //	cbi(SPCR, SPR1);
-	// clock = f/16
+	// clock = f/64
 	cbi(SPCR, SPR0);
 	sbi(SPCR, SPR1);
 	// select clock phase positive-going in middle of data
@@ -102,12 +104,16 @@ void spiInit()
 	sbi(SPCR, SPIE);
 	#endif
 }
-/*
-void spiSetBitrate(u08 spr)
+
+void spiSetClock(u08 rate)
 {
-	outb(SPCR, (inb(SPCR) & ((1<<SPR0)|(1<<SPR1))) | (spr&((1<<SPR0)|(1<<SPR1)))));
+	outb(SPCR, (inb(SPCR) & ~((1<<SPR0)|(1<<SPR1))) | (rate & 0x03));
+	if(rate & 0x04)
+		sbi(SPSR, SPI2X);
+	else
+		cbi(SPSR, SPI2X);
 }
-*/
+
 void spiSendByte(u08 data)
 {
 	// send a byte over SPI and ignore reply
@@ -151,3 +157,52 @@ u16 spiTransferWord(u16 data)
 	// return the received data
 	return rxData;
 }
+
+void spiReceiveBlock(u08* buffer, u16 count)
+{
+	#ifdef SPI_USEINT
+	while(count--)
+		*buffer++ = spiTransferByte(0xFF);
+	#else
+	u08 data;
+
+	if(!count)
+		return;
+	// start the first transfer, then reload SPDR the moment each byte
+	// arrives and store it while the next one is on the wire
+	outb(SPDR, 0xFF);
+	while(--count)
+	{
+		while(!(inb(SPSR) & (1<<SPIF)));
+		data = inb(SPDR);
+		outb(SPDR, 0xFF);
+		*buffer++ = data;
+	}
+	while(!(inb(SPSR) & (1<<SPIF)));
+	*buffer = inb(SPDR);
+	#endif
+}
+
+void spiSendBlock(u08* buffer, u16 count)
+{
+	#ifdef SPI_USEINT
+	while(count--)
+		spiTransferByte(*buffer++);
+	#else
+	u08 data;
+
+	if(!count)
+		return;
+	outb(SPDR, *buffer++);
+	while(--count)
+	{
+		// fetch the next byte while the current one is shifted out
+		data = *buffer++;
+		while(!(inb(SPSR) & (1<<SPIF)));
+		outb(SPDR, data);
+	}
+	while(!(inb(SPSR) & (1<<SPIF)));
+	// leave the receive register read, as spiTransferByte() does
+	inb(SPDR);
+	#endif
+}
@@ -34,11 +34,24 @@
 
 #include "global.h"
 
+// SPI clock rates for spiSetClock() (SPI2X in bit 2, SPR1:SPR0 in bits 1:0)
+#define SPI_CLK_DIV2		0x04	///< SPI clock = F_CPU/2
+#define SPI_CLK_DIV4		0x00	///< SPI clock = F_CPU/4
+#define SPI_CLK_DIV8		0x05	///< SPI clock = F_CPU/8
+#define SPI_CLK_DIV16		0x01	///< SPI clock = F_CPU/16
+#define SPI_CLK_DIV32		0x06	///< SPI clock = F_CPU/32
+#define SPI_CLK_DIV64		0x02	///< SPI clock = F_CPU/64 (spiInit() default)
+#define SPI_CLK_DIV128		0x03	///< SPI clock = F_CPU/128
+
 // function prototypes
 
 // SPI interface initializer
 void spiInit(void);
 
+// spiSetClock(u08 rate) selects the SPI clock rate, one of the
+// SPI_CLK_DIVx values above.  Wait for any transfer to finish first.
+void spiSetClock(u08 rate);
+
 // spiSendByte(u08 data) waits until the SPI interface is ready
 // and then sends a single byte over the SPI port.  This command
 // does not receive anything.
@@ -53,4 +66,12 @@ u08 spiTransferByte(u08 data);
 // operates on a whole word (16-bits of data).
 u16 spiTransferWord(u16 data);
 
+// spiReceiveBlock(u08* buffer, u16 count) clocks in count bytes while
+// sending 0xFF, starting each transfer as soon as the previous one ends.
+void spiReceiveBlock(u08* buffer, u16 count);
+
+// spiSendBlock(u08* buffer, u16 count) sends count bytes back to back
+// and ignores the received data.
+void spiSendBlock(u08* buffer, u16 count);
+
 #endif
@@ -25,7 +25,7 @@
 #include "spiflash.h"
 
 #define SPIFLASH_CONFIG_CS		DDRB  |= (1<<0)
-#define SPIFLASH_ASSERT_CS		PORTB &= (1<<0)
+#define SPIFLASH_ASSERT_CS		PORTB &= ~(1<<0)
 #define SPIFLASH_RELEASE_CS		PORTB |= (1<<0)
 
 // functions
@@ -76,6 +76,35 @@ void spiflashChipErase(void)
 	SPIFLASH_RELEASE_CS;
 }
 
+void spiflashSectorErase(unsigned long addr)
+{
+	// enable write
+	SPIFLASH_ASSERT_CS;
+	spiByte(0, SPIFLASH_CMD_WREN, 1);
+	SPIFLASH_RELEASE_CS;
+
+	// clock out dummy byte to waste time
+	spiByte(0, 0x00, 1);
+
+	// do sector erase
+	SPIFLASH_ASSERT_CS;
+	spiByte(0, SPIFLASH_CMD_SECTERASE, 0);
+	// send address
+	spiByte(0, addr>>16, 0);
+	spiByte(0, addr>>8, 0);
+	spiByte(0, addr>>0, 0);
+	SPIFLASH_RELEASE_CS;
+
+	// clock out dummy byte to waste time
+	spiByte(0, 0x00, 1);
+
+	// wait until erase is done
+	SPIFLASH_ASSERT_CS;
+	spiByte(0, SPIFLASH_CMD_RDSR, 0);
+	while(spiByte(0, 0x00, 0) & SPIFLASH_STATUS_BUSY);
+	SPIFLASH_RELEASE_CS;
+}
+
 void spiflashRead(unsigned long addr, unsigned long nbytes, unsigned char *data)
 {
 	// begin read
@@ -130,6 +159,8 @@ void spiflashWrite(unsigned long addr, unsigned long nbytes, unsigned char *data
 			spiByte(0, *data++, 0);
 		// end write
 		SPIFLASH_RELEASE_CS;
+		// next page
+		addr += pagelen;
 
 		// clock out dummy byte to waste time
 		spiByte(0, 0x00, 1);
@@ -144,3 +175,56 @@ void spiflashWrite(unsigned long addr, unsigned long nbytes, unsigned char *data
 		spiByte(0, 0x00, 1);
 	}
 }
+
+// block device operations
+static u08 spiflashBlockRead(BlockDev* dev, u32 block, u16 count, u08* buffer)
+{
+	spiflashRead(block<<9, (unsigned long)count<<9, buffer);
+	return 0;
+}
+
+static u08 spiflashBlockWrite(BlockDev* dev, u32 block, u16 count, u08* buffer)
+{
+	spiflashWrite(block<<9, (unsigned long)count<<9, buffer);
+	return 0;
+}
+
+const BlockDevOps spiflashBlockDevOps = {spiflashBlockRead, spiflashBlockWrite, 0};
+
+void spiflashBlockDevInit(BlockDev* dev, unsigned long blocks)
+{
+	blockdevInit(dev, &spiflashBlockDevOps, blocks);
+}
+
+// flash log operations
+static u08 spiflashLogRead(FlashLog* log, u32 addr, u16 nbytes, u08* data)
+{
+	spiflashRead(addr, nbytes, data);
+	return 0;
+}
+
+static u08 spiflashLogProgram(FlashLog* log, u32 addr, u16 nbytes, u08* data)
+{
+	u16 len;
+
+	// spiflashWrite() can't cross a page boundary from an unaligned address
+	while(nbytes)
+	{
+		len = SPIFLASH_PAGESIZE - (addr & (SPIFLASH_PAGESIZE-1));
+		if(len > nbytes)
+			len = nbytes;
+		spiflashWrite(addr, len, data);
+		addr += len;
+		data += len;
+		nbytes -= len;
+	}
+	return 0;
+}
+
+static u08 spiflashLogErase(FlashLog* log, u32 addr)
+{
+	spiflashSectorErase(addr);
+	return 0;
+}
+
+const FlashLogOps spiflashLogOps = {spiflashLogRead, spiflashLogProgram, spiflashLogErase};
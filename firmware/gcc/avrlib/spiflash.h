@@ -20,6 +20,8 @@
 #define AVRLIB_SPIFLASH_H
 
 #include "global.h"
+#include "blockdev.h"
+#include "flashlog.h"
 
 // Compatible with:
 // - ST M25Pxx devices
@@ -61,6 +63,10 @@ unsigned short spiflashGetID(void);
 // Erase entire flash chip
 void spiflashChipErase(void);
 
+// Erase the sector containing addr
+// - the sector size depends on the device (64K on M25P16/32/64)
+void spiflashSectorErase(unsigned long addr);
+
 // Read flash memory
 // - addr may be any value
 // - nbytes may be any value
@@ -73,4 +79,17 @@ void spiflashRead(unsigned long addr, unsigned long nbytes, unsigned char *data)
 // - nbytes must be small enough such that page boundary is not crossed
 void spiflashWrite(unsigned long addr, unsigned long nbytes, unsigned char *data);
 
+// Block device operations (see blockdev.h)
+// - block n is at flash address n*512
+// - writes program the flash without erasing it, so they only work on
+//   erased flash (e.g. loading a filesystem image after spiflashChipErase())
+extern const BlockDevOps spiflashBlockDevOps;
+
+// Sets up a block device for the flash, which holds the given number of blocks
+void spiflashBlockDevInit(BlockDev* dev, unsigned long blocks);
+
+// Flash log operations (see flashlog.h)
+// - FLASHLOG_SECTOR_SIZE must match the device's sector erase size
+extern const FlashLogOps spiflashLogOps;
+
 #endif
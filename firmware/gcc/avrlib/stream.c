@@ -0,0 +1,81 @@
+/*! \file stream.c \brief Common byte-stream interface for serial devices. */
+//*****************************************************************************
+//
+// File Name	: 'stream.c'
+// Title		: Common byte-stream interface for serial devices
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include "global.h"
+#include "buffer.h"
+#include "stream.h"
+
+void streamInit(Stream* stream, const StreamOps* ops)
+{
+	// attach device operations
+	stream->ops = ops;
+	// reset statistics
+	streamClearStats(stream);
+}
+
+u16 streamAvailable(Stream* stream)
+{
+	u16 n = stream->ops->rxBuffer()->datalength;
+	// track the high-water mark to help size buffers
+	if(n > stream->stats.rxPeak)
+		stream->stats.rxPeak = n;
+	return n;
+}
+
+void streamFlush(Stream* stream)
+{
+	stream->ops->flush();
+}
+
+u16 streamReadBlock(Stream* stream, u08* data, u16 len)
+{
+	int (*read)(void) = stream->ops->read;
+	u16 n;
+	int c;
+
+	// pull bytes until we have len of them or the device runs dry
+	for(n=0; n<len; n++)
+	{
+		if((c = read()) < 0)
+			break;
+		*data++ = c;
+	}
+	stream->stats.rxBytes += n;
+	return n;
+}
+
+void streamWriteBlock(Stream* stream, const u08* data, u16 len)
+{
+	void (*write)(u08 data) = stream->ops->write;
+	u16 n = len;
+
+	while(n--)
+		write(*data++);
+	stream->stats.txBytes += len;
+}
+
+StreamStats* streamGetStats(Stream* stream)
+{
+	return &stream->stats;
+}
+
+void streamClearStats(Stream* stream)
+{
+	stream->stats.rxBytes = 0;
+	stream->stats.txBytes = 0;
+	stream->stats.rxPeak = 0;
+}
@@ -0,0 +1,129 @@
+/*! \file stream.h \brief Common byte-stream interface for serial devices. */
+//*****************************************************************************
+//
+// File Name	: 'stream.h'
+// Title		: Common byte-stream interface for serial devices
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+///	\ingroup general
+/// \defgroup stream Byte-Stream Interface (stream.c)
+/// \code #include "stream.h" \endcode
+/// \par Overview
+///		The serial drivers in avrlib (uart, uart2, uartsw, uartsw2, megaio)
+///		each have their own set of send/receive functions.  This library puts
+///		a common face on all of them.  Each driver exports a table of stream
+///		operations (StreamOps), and a Stream descriptor binds a table to a
+///		block of per-stream statistics.  Code written against a Stream* can
+///		then be attached to any serial port without glue functions.
+///	\code
+/// Stream gpsStream;
+///
+/// uartswInit();
+/// streamInit(&gpsStream, &uartswStreamOps);
+///
+/// rprintfInitStream(&gpsStream);			// rprintf output to the port
+/// nmeaProcess(streamGetRxBuffer(&gpsStream));	// parse directly from its buffer
+/// \endcode
+///
+/// \note	The byte-sized operations are inline so that libraries can accept
+///		a Stream* without having to link stream.c.  Bulk operations are in
+///		stream.c.
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+//@{
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "global.h"
+#include "buffer.h"
+
+// structure/typdefs
+
+//! Stream operations table.
+/// Each serial driver provides one of these.  The read and flush operations
+/// go through the driver (not directly to the buffer) so that drivers which
+/// need to see buffer activity, like uart flow control, keep working.
+typedef struct struct_StreamOps
+{
+	void		(*write)(u08 data);	///< send a byte (waits until accepted)
+	int			(*read)(void);		///< get a received byte, or -1 if none
+	cBuffer*	(*rxBuffer)(void);	///< returns the receive buffer (refreshed if necessary)
+	void		(*flush)(void);		///< flush (delete) all received data
+} StreamOps;
+
+//! Per-stream statistics.
+typedef struct struct_StreamStats
+{
+	u32 rxBytes;			///< bytes read through the stream
+	u32 txBytes;			///< bytes written through the stream
+	u16 rxPeak;				///< largest receive backlog seen by streamAvailable()
+} StreamStats;
+
+//! Stream descriptor.
+typedef struct struct_Stream
+{
+	const StreamOps* ops;	///< device operations
+	StreamStats stats;		///< statistics
+} Stream;
+
+// functions
+
+//! Initialize a stream descriptor to use the given device operations.
+void streamInit(Stream* stream, const StreamOps* ops);
+
+//! Send a single byte.
+static inline void streamWrite(Stream* stream, u08 data)
+{
+	stream->ops->write(data);
+	stream->stats.txBytes++;
+}
+
+//! Get a single received byte.
+/// Returns the byte, or -1 if no byte is available (getchar-style).
+static inline int streamRead(Stream* stream)
+{
+	int c = stream->ops->read();
+	if(c >= 0)
+		stream->stats.rxBytes++;
+	return c;
+}
+
+//! Returns the stream's receive buffer.
+/// Parsers which take a cBuffer* (nmeaProcess, stxetxProcess, tsipProcess)
+/// can work on this directly.  Bytes consumed that way are not counted
+/// in the stream statistics.
+static inline cBuffer* streamGetRxBuffer(Stream* stream)
+{
+	return stream->ops->rxBuffer();
+}
+
+//! Returns the number of received bytes waiting to be read.
+u16 streamAvailable(Stream* stream);
+
+//! Flush (delete) all received data.
+void streamFlush(Stream* stream);
+
+//! Read up to len bytes into data without waiting.
+/// Returns the number of bytes actually read.
+u16 streamReadBlock(Stream* stream, u08* data, u16 len);
+
+//! Send len bytes from data.
+void streamWriteBlock(Stream* stream, const u08* data, u16 len);
+
+//! Returns pointer to the stream's statistics.
+StreamStats* streamGetStats(Stream* stream);
+
+//! Clear the stream's statistics.
+void streamClearStats(Stream* stream);
+
+#endif
+//@}
@@ -0,0 +1,217 @@
+/*! \file swtimer.c \brief Software timer service. */
+//*****************************************************************************
+//
+// File Name	: 'swtimer.c'
+// Title		: Software timer service
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "global.h"
+#include "swtimer.h"
+#include "isrstat.h"
+
+#ifndef CRITICAL_SECTION_START
+#define CRITICAL_SECTION_START	unsigned char _sreg = SREG; cli()
+#define CRITICAL_SECTION_END	SREG = _sreg
+#endif
+
+// timer states
+#define SWTIMER_STOPPED		0x00
+#define SWTIMER_RUNNING		0x01	// in the running list
+#define SWTIMER_READY		0x02	// in the ready list
+
+// global variables
+static volatile u16 SwTimerTicks;
+// running timers, soonest first
+static SwTimer* volatile SwTimerList;
+// deferred timers waiting for swtimerService(), in expiry order
+static SwTimer* volatile SwTimerReadyHead;
+static SwTimer* volatile SwTimerReadyTail;
+
+// functions
+
+void swtimerInit(void)
+{
+	SwTimerTicks = 0;
+	SwTimerList = 0;
+	SwTimerReadyHead = 0;
+	SwTimerReadyTail = 0;
+}
+
+// insert a timer into the running list in expiry order
+// (call with interrupts off)
+static void swtimerInsert(SwTimer* timer)
+{
+	SwTimer** pp = (SwTimer**)&SwTimerList;
+	u16 now = SwTimerTicks;
+	u16 remaining = timer->expires - now;
+
+	// timers due at the same time stay in the order they were started
+	while(*pp && ((u16)((*pp)->expires - now) <= remaining))
+		pp = &(*pp)->next;
+	timer->next = *pp;
+	*pp = timer;
+	timer->state |= SWTIMER_RUNNING;
+}
+
+// remove a timer from the running list
+// (call with interrupts off)
+static void swtimerRemove(SwTimer* timer)
+{
+	SwTimer** pp = (SwTimer**)&SwTimerList;
+
+	while(*pp)
+	{
+		if(*pp == timer)
+		{
+			*pp = timer->next;
+			break;
+		}
+		pp = &(*pp)->next;
+	}
+	timer->state &= ~SWTIMER_RUNNING;
+}
+
+// remove a timer from the ready list
+// (call with interrupts off)
+static void swtimerRemoveReady(SwTimer* timer)
+{
+	SwTimer** pp = (SwTimer**)&SwTimerReadyHead;
+	SwTimer* prev = 0;
+
+	while(*pp)
+	{
+		if(*pp == timer)
+		{
+			*pp = timer->nextReady;
+			if(SwTimerReadyTail == timer)
+				SwTimerReadyTail = prev;
+			break;
+		}
+		prev = *pp;
+		pp = &(*pp)->nextReady;
+	}
+	timer->state &= ~SWTIMER_READY;
+}
+
+void swtimerTick(void)
+{
+	SwTimer* timer;
+
+	SwTimerTicks++;
+
+	// only the head of the list can be due
+	while((timer = SwTimerList) && (timer->expires == SwTimerTicks))
+	{
+		// take it off the list, and reload it if periodic
+		SwTimerList = timer->next;
+		timer->state &= ~SWTIMER_RUNNING;
+		if(timer->period)
+		{
+			timer->expires += timer->period;
+			swtimerInsert(timer);
+		}
+
+		if(timer->flags & SWTIMER_DEFERRED)
+		{
+			// queue for the main loop (once)
+			if(!(timer->state & SWTIMER_READY))
+			{
+				timer->nextReady = 0;
+				if(SwTimerReadyTail)
+					SwTimerReadyTail->nextReady = timer;
+				else
+					SwTimerReadyHead = timer;
+				SwTimerReadyTail = timer;
+				timer->state |= SWTIMER_READY;
+			}
+		}
+		else
+		{
+			// call it now
+			timer->func();
+		}
+	}
+}
+
+void swtimerService(void)
+{
+	SwTimer* timer;
+	void (*func)(void);
+
+	for(;;)
+	{
+		// take the next ready timer off the list
+		CRITICAL_SECTION_START;
+		timer = SwTimerReadyHead;
+		if(timer)
+		{
+			SwTimerReadyHead = timer->nextReady;
+			if(!SwTimerReadyHead)
+				SwTimerReadyTail = 0;
+			timer->state &= ~SWTIMER_READY;
+			func = timer->func;
+		}
+		CRITICAL_SECTION_END;
+
+		if(!timer)
+			break;
+		// call with interrupts on
+		func();
+	}
+}
+
+void swtimerStart(SwTimer* timer, u16 ticks, u16 period, void (*func)(void), u08 flags)
+{
+	CRITICAL_SECTION_START;
+	// restarting a timer drops anything it had pending
+	if(timer->state & SWTIMER_RUNNING)
+		swtimerRemove(timer);
+	if(timer->state & SWTIMER_READY)
+		swtimerRemoveReady(timer);
+	timer->func = func;
+	timer->period = period;
+	timer->flags = flags;
+	// a timer can't expire on the current tick
+	if(!ticks)
+		ticks = 1;
+	timer->expires = SwTimerTicks + ticks;
+	swtimerInsert(timer);
+	CRITICAL_SECTION_END;
+}
+
+void swtimerStop(SwTimer* timer)
+{
+	CRITICAL_SECTION_START;
+	if(timer->state & SWTIMER_RUNNING)
+		swtimerRemove(timer);
+	if(timer->state & SWTIMER_READY)
+		swtimerRemoveReady(timer);
+	CRITICAL_SECTION_END;
+}
+
+u08 swtimerIsActive(SwTimer* timer)
+{
+	return (timer->state)?(TRUE):(FALSE);
+}
+
+u16 swtimerGetTicks(void)
+{
+	u16 ticks;
+	CRITICAL_SECTION_START;
+	ticks = SwTimerTicks;
+	CRITICAL_SECTION_END;
+	return ticks;
+}
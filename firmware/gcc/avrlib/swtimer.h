@@ -0,0 +1,103 @@
+/*! \file swtimer.h \brief Software timer service. */
+//*****************************************************************************
+//
+// File Name	: 'swtimer.h'
+// Title		: Software timer service
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: Atmel AVR Series
+// Editor Tabs	: 4
+//
+///	\ingroup general
+/// \defgroup swtimer Software Timer Service (swtimer.c)
+/// \code #include "swtimer.h" \endcode
+/// \par Overview
+///		This library runs any number of one-shot and periodic software timers
+///		from a single periodic "tick", such as a hardware timer overflow
+///		interrupt.  This lets protocol timers (ARP, DHCP), debounce, RTC and
+///		alarm timing all share one hardware timer.
+///	\par
+///		Running timers are kept in a list sorted by expiry time, so each tick
+///		only has to look at the head of the list, however many timers are
+///		running.  Starting a timer walks the list to find its place.
+///	\par
+///		A timer's function is either called directly from the tick interrupt
+///		(keep it short), or, with the SWTIMER_DEFERRED flag, queued and called
+///		from the main loop by swtimerService().  A deferred periodic timer
+///		that expires again before it has been serviced is only called once.
+///	\code
+/// SwTimer blinkTimer;
+///
+/// swtimerInit();
+/// timerAttach(TIMER2OVERFLOW_INT, swtimerTick);
+/// swtimerStart(&blinkTimer, 50, 50, blink, SWTIMER_DEFERRED);
+/// while(1)
+///		swtimerService();
+/// \endcode
+///	\note Times are in ticks and use a 16-bit wrapping counter, so a timer
+///		can be at most 32767 ticks long.
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+//@{
+
+#ifndef SWTIMER_H
+#define SWTIMER_H
+
+#include "global.h"
+
+// timer flags
+#define SWTIMER_ISR			0x00	///< call function from the tick interrupt
+#define SWTIMER_DEFERRED	0x01	///< call function from swtimerService()
+
+//! Software timer
+/// The structure is owned by the caller and must stay in memory while the
+/// timer is running.  Its fields are private to the library.  It must start
+/// out zeroed, as global and static variables are.
+typedef struct SwTimerStruct
+{
+	struct SwTimerStruct* next;		///< next running timer (sorted by expiry)
+	struct SwTimerStruct* nextReady;///< next deferred timer waiting for service
+	void (*func)(void);				///< function to call on expiry
+	u16 expires;					///< tick count at expiry
+	u16 period;						///< reload period in ticks (0 = one-shot)
+	u08 flags;						///< SWTIMER_ISR or SWTIMER_DEFERRED
+	u08 state;						///< running/ready state
+} SwTimer;
+
+// functions
+
+//! Initializes the software timer service (no timers running).
+void swtimerInit(void);
+
+//! Advances time by one tick and runs expired timers.
+/// Call this from a periodic interrupt, e.g. with timerAttach().
+void swtimerTick(void);
+
+//! Calls the functions of expired deferred timers.
+/// Call this regularly from the main loop.
+void swtimerService(void);
+
+//! Starts (or restarts) a timer.
+/// \param timer	timer to start
+/// \param ticks	ticks until the first expiry (1-32767)
+/// \param period	ticks between later expiries, or 0 for a one-shot timer
+/// \param func		function to call on expiry
+/// \param flags	SWTIMER_ISR or SWTIMER_DEFERRED
+void swtimerStart(SwTimer* timer, u16 ticks, u16 period, void (*func)(void), u08 flags);
+
+//! Stops a timer (including a pending deferred call).
+void swtimerStop(SwTimer* timer);
+
+//! Returns TRUE if the timer is running, or waiting for service.
+u08 swtimerIsActive(SwTimer* timer);
+
+//! Returns the tick count.
+u16 swtimerGetTicks(void);
+
+#endif
+//@}
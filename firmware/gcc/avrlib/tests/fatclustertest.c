@@ -0,0 +1,155 @@
+//*****************************************************************************
+//
+// File Name	: 'fatclustertest.c'
+// Title		: Host test for FAT cluster and sector-run loads
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: PC (Linux, for testing)
+// Editor Tabs	: 4
+//
+// Reads every file in the SOUNDS directory of an image built by mkfat.py,
+// whose volume does not start on a cluster boundary and whose chains are
+// fragmented, and checks that:
+//	- fatLoadCluster() reads each cluster in one transfer
+//	- fatLoadSectors() reads parts of clusters, and refuses to run past one
+//	- fatFileReadSectors() reads sector ranges in one transfer per run of
+//	  consecutive sectors
+// and that all of them return the file's data.
+//
+//	fatclustertest <image>
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+#include "blockdev.h"
+#include "fat.h"
+
+// buffers named in fatconf.h
+unsigned char FatFileNameBuffer[256];
+unsigned char FatPathNameBuffer[256];
+
+#define MAX_CHAIN	64
+
+static BlockDev Disk;
+static unsigned char Buffer[MAX_CHAIN*8*512];
+static int Fails;
+
+#define CHECK(c)	do { if(!(c)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #c); if(++Fails > 10) exit(1); } } while(0)
+
+// checks <count> sectors read from file sector <first> against mkfat.py's pattern
+static void checkData(u32 start, u32 size, u32 first, u32 count)
+{
+	u32 pos, i;
+
+	for(i=0; i<count*512; i++)
+	{
+		pos = first*512 + i;
+		if((pos < size) && (Buffer[i] != (unsigned char)(start*7 + pos)))
+		{
+			printf("FAIL: file at cluster %u: byte %u is wrong\n", start, pos);
+			Fails++;
+			return;
+		}
+	}
+}
+
+// returns the number of transfers it takes to read file sectors first..first+count-1
+static u32 countRuns(u32* chain, u32 spc, u32 first, u32 count)
+{
+	u32 s, runs = 0;
+
+	for(s=first; s<first+count; s++)
+		if((s == first) || ((s % spc == 0) && (chain[s/spc] != chain[s/spc-1]+1)))
+			runs++;
+	return runs;
+}
+
+static void checkFile(u32 start, u32 size, u32 spc, u32* transfers, u32* sectors)
+{
+	FatFile f;
+	u32 chain[MAX_CHAIN];
+	u32 c, n, i, k, first, count, want, runs, reads;
+
+	n = 0;
+	for(c=start; c && (n < MAX_CHAIN); c=fatNextCluster(c))
+		chain[n++] = c;
+	CHECK((n > 0) && (n < MAX_CHAIN));
+
+	// whole clusters, one transfer each
+	for(i=0; i<n; i++)
+	{
+		reads = Disk.stats.reads;
+		fatLoadCluster(chain[i], Buffer);
+		CHECK(Disk.stats.reads - reads == 1);
+		checkData(start, size, i*spc, spc);
+	}
+
+	// parts of clusters
+	for(k=0; k<10; k++)
+	{
+		i = rand() % n;
+		first = rand() % spc;
+		count = 1 + rand() % (spc - first);
+		CHECK(fatLoadSectors(chain[i], first, count, Buffer));
+		checkData(start, size, i*spc + first, count);
+	}
+	CHECK(!fatLoadSectors(chain[0], spc-1, 2, Buffer));
+
+	// sector ranges of the file, including ranges running past its end
+	fatFileOpen(&f, start, size);
+	for(k=0; k<20; k++)
+	{
+		first = rand() % (n*spc);
+		count = 1 + rand() % (n*spc - first + 3);
+		want = (first + count > n*spc) ? n*spc - first : count;
+		runs = countRuns(chain, spc, first, want);
+		// decode the chain ahead so that FAT reads are not counted
+		fatFileSector(&f, first + count);
+		reads = Disk.stats.reads;
+		CHECK(fatFileReadSectors(&f, first, count, Buffer) == want);
+		CHECK(Disk.stats.reads - reads == runs);
+		checkData(start, size, first, want);
+		*transfers += runs;
+		*sectors += want;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	u32 spc, files = 0, transfers = 0, sectors = 0;
+	int e;
+
+	if(argc != 2)
+	{
+		printf("usage: fatclustertest <image>\n");
+		return 2;
+	}
+	if(blockdevFileOpen(&Disk, argv[1]))
+	{
+		printf("can't open %s\n", argv[1]);
+		return 2;
+	}
+	srand(9);
+	fatInit(&Disk);
+	spc = fatClusterSize();
+	e = fatFindEntry("sounds");
+	CHECK((e >= 0) && fatChangeDirectory(e));
+	for(e=2; fatGetDirEntry(e); e++)
+	{
+		checkFile(fatGetFileInfo()->StartCluster, fatGetFilesize(), spc, &transfers, &sectors);
+		files++;
+	}
+	CHECK(files > 100);
+	printf("%u files, %u sectors per cluster, %u sectors in %u transfers\n", files, spc, sectors, transfers);
+	printf(Fails ? "fatclustertest %s: %d FAILED\n" : "fatclustertest %s: ok\n", argv[1], Fails);
+	return Fails != 0;
+}
@@ -0,0 +1,42 @@
+/*! \file fatconf.h \brief FAT16/32 file system driver configuration for the host tests. */
+//*****************************************************************************
+//
+// File Name	: 'fatconf.h'
+// Title		: FAT16/32 file system driver configuration for the host tests
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: PC (Linux, for testing)
+// Editor Tabs	: 4
+//
+// Same options as conf/fatconf.h, but with the name buffers in arrays
+// defined by each test instead of at fixed addresses.
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#ifndef FATCONF_H
+#define FATCONF_H
+
+extern unsigned char FatFileNameBuffer[256];
+extern unsigned char FatPathNameBuffer[256];
+
+#define FAT_FILENAME_BUFFER_ADDR	FatFileNameBuffer
+#define FAT_FILENAME_BUFFER_SIZE	0x0100
+
+#define FAT_PATHNAME_BUFFER_ADDR	FatPathNameBuffer
+#define FAT_PATHNAME_BUFFER_SIZE	0x0100
+
+#define FAT_FILE_EXTENTS			8
+
+#define FAT_WRITE
+#define FAT_WRITE_PENDING			4
+
+#define FAT_DIR_INDEX
+#define FAT_DIR_INDEX_SIZE			128
+#define FAT_DIR_INDEX_STEP			16
+
+#endif
@@ -0,0 +1,171 @@
+//*****************************************************************************
+//
+// File Name	: 'fatcuttest.c'
+// Title		: Power-cut harness for the FAT write path
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: PC (Linux, for testing)
+// Editor Tabs	: 4
+//
+// Appends records of random length to LOG.TXT on a disk image, syncing now
+// and then, and cuts the power once a given number of sectors have been
+// written.  fatcuttest.py runs it for many cut points and checks the image
+// with fsck.py.
+//
+//	fatcuttest <image> <sectors> [<directory>|- [recover]]
+//
+// <sectors> is the write budget (-1 for none).  Byte n of the log is
+// (n*13+5) & 0xFF.  Progress is printed as "OPEN <written> <size>" and
+// "SYNC <written> <size>" lines, and the cut as "CUT <written>".  With
+// recover, the power comes back after the cut: the cache is dropped, the
+// volume remounted, and 100 bytes of ((size+i)*7+3) & 0xFF appended after
+// the size found on reopening ("REOPEN <size>", "APPEND <size>").
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+#include "blockdev.h"
+#include "seccache.h"
+#include "fat.h"
+
+// buffers named in fatconf.h
+unsigned char FatFileNameBuffer[256];
+unsigned char FatPathNameBuffer[256];
+
+static BlockDev Image;			// the image file
+static BlockDev Disk;			// the image as seen through the power supply
+static long Budget;				// sectors that can be written before the cut
+static long Written;			// sectors written
+static int Recover;				// remount after the cut
+static jmp_buf PowerCut;
+
+static u08 cutRead(BlockDev* dev, u32 block, u16 count, u08* buffer)
+{
+	return blockdevRead(&Image, block, count, buffer);
+}
+
+// writes that would go past the budget are not started
+static u08 cutWrite(BlockDev* dev, u32 block, u16 count, u08* buffer)
+{
+	if((Budget >= 0) && (Written + count > Budget))
+	{
+		printf("CUT %ld\n", Written);
+		fflush(stdout);
+		if(Recover)
+			longjmp(PowerCut, 1);
+		exit(0);
+	}
+	Written += count;
+	return blockdevWrite(&Image, block, count, buffer);
+}
+
+static const BlockDevOps CutOps = {cutRead, cutWrite, 0};
+
+static void fail(const char* what)
+{
+	printf("%s failed\n", what);
+	exit(1);
+}
+
+static void mount(const char* dir, FatWriter* w)
+{
+	int e;
+
+	if(fatInit(&Disk))
+		fail("mount");
+	if(dir)
+	{
+		e = fatFindEntry((char*)dir);
+		if((e < 0) || !fatChangeDirectory(e))
+			fail("change directory");
+	}
+	if(!fatWriteOpen(w, "log.txt"))
+		fail("open");
+}
+
+// appends <records> records of up to 700 bytes
+static void writeLog(const char* dir, int records, unsigned int seed)
+{
+	FatWriter w;
+	unsigned char buffer[700];
+	int r, i, len;
+
+	srand(seed);
+	mount(dir, &w);
+	printf("OPEN %ld %lu\n", Written, (unsigned long)w.size);
+	for(r=0; r<records; r++)
+	{
+		len = rand()%700 + 1;
+		for(i=0; i<len; i++)
+			buffer[i] = (w.size + i)*13 + 5;
+		if(fatWrite(&w, buffer, len) != len)
+			fail("write");
+		if((rand()%4 == 0) || (r == records-1))
+		{
+			if(!fatWriteSync(&w))
+				fail("sync");
+			printf("SYNC %ld %lu\n", Written, (unsigned long)w.size);
+		}
+	}
+}
+
+// power is back: remount and append a marker after the file's size
+static void appendAfterCut(const char* dir)
+{
+	FatWriter w;
+	unsigned char buffer[100];
+	int i;
+
+	Budget = -1;
+	seccacheInit();
+	mount(dir, &w);
+	printf("REOPEN %lu\n", (unsigned long)w.size);
+	for(i=0; i<100; i++)
+		buffer[i] = (w.size + i)*7 + 3;
+	if((fatWrite(&w, buffer, 100) != 100) || !fatWriteSync(&w))
+		fail("append");
+	printf("APPEND %lu\n", (unsigned long)w.size);
+}
+
+int main(int argc, char** argv)
+{
+	const char* dir = 0;
+
+	if((argc < 3) || (argc > 5))
+	{
+		printf("usage: fatcuttest <image> <sectors> [<directory>|- [recover]]\n");
+		return 2;
+	}
+	if(blockdevFileOpen(&Image, argv[1]))
+	{
+		printf("can't open %s\n", argv[1]);
+		return 2;
+	}
+	Budget = atol(argv[2]);
+	if((argc > 3) && strcmp(argv[3], "-"))
+		dir = argv[3];
+	Recover = (argc > 4);
+	blockdevInit(&Disk, &CutOps, blockdevGetBlocks(&Image));
+	seccacheInit();
+
+	if(setjmp(PowerCut))
+	{
+		appendAfterCut(dir);
+		return 0;
+	}
+	// two sessions, so that the second appends to an existing file
+	writeLog(dir, 60, 1);
+	writeLog(dir, 60, 2);
+	printf("TOTAL %ld\n", Written);
+	return 0;
+}
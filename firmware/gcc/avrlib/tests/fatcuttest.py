@@ -0,0 +1,101 @@
+# fatcuttest.py - power-cut test of the FAT write path
+#
+#	python3 fatcuttest.py <fatcuttest program> <image>...
+#
+# For each image, and for a log in the root directory and in SOUNDS, runs
+# fatcuttest once without a cut to find the write and sync points, then
+# cuts the power at 150 random points and at the first 20 syncs.  After each
+# cut fsck.py must find no damage, the log must hold everything up to the
+# last completed sync, and whatever it holds beyond that must be log data.
+# It then cuts at another 150 points, powers up again and appends: the log
+# must continue right after the size found on reopening, with no chain left
+# longer than its file.
+
+import os, random, shutil, subprocess, sys
+from fsck import check, DAMAGE
+
+def logData(n):
+	return bytes((k*13 + 5) & 0xFF for k in range(n))
+
+def appendData(size, n):
+	return bytes(((size + i)*7 + 3) & 0xFF for i in range(n))
+
+def run(program, image, budget, dir, recover=False):
+	args = [program, image, str(budget), dir] + (['recover'] if recover else [])
+	out = subprocess.run(args, capture_output=True, text=True).stdout
+	return [line.split() for line in out.splitlines()]
+
+def damaged(problems):
+	return any(p in DAMAGE for p in problems)
+
+def testImage(program, base, dir):
+	work = base + '.cut'
+	logName = '/LOG.TXT' if dir == '-' else '/SOUNDS/LOG.TXT'
+	fails = 0
+
+	# uninterrupted run
+	shutil.copy(base, work)
+	lines = run(program, work, -1, dir)
+	total = int(lines[-1][1])
+	syncs = [(int(l[1]), int(l[2])) for l in lines if l[0] == 'SYNC']
+	problems, files, contents = check(work)
+	if problems or contents(logName) != logData(syncs[-1][1]):
+		print('FAIL: %s %s: uninterrupted run left %s' % (base, dir, problems))
+		return 1
+
+	# cut, then check the image as left
+	rnd = random.Random(7)
+	cuts = sorted(set(rnd.sample(range(total + 1), 150)) | set(w for w, s in syncs[:20]))
+	states = {}
+	for cut in cuts:
+		shutil.copy(base, work)
+		run(program, work, cut, dir)
+		problems, files, contents = check(work)
+		committed = max([s for w, s in syncs if w <= cut], default=0)
+		ok = not damaged(problems)
+		if logName in files:
+			data = contents(logName)
+			if len(data) < committed or data != logData(len(data)):
+				ok = False
+		elif committed:
+			ok = False
+		# a cut just after a sync must leave a clean volume
+		if cut in [w for w, s in syncs] and problems:
+			ok = False
+		if not ok:
+			print('FAIL: %s %s: cut at %d: %s, %d bytes synced' % (base, dir, cut, sorted(problems), committed))
+			fails += 1
+		key = ','.join(sorted(problems)) or 'clean'
+		states[key] = states.get(key, 0) + 1
+	print('%s %s: %d sectors, %d syncs, cuts left %s' % (base, dir, total, len(syncs), states))
+
+	# cut, power up and append
+	rnd = random.Random(11)
+	states = {}
+	for cut in sorted(rnd.sample(range(total), 150)):
+		shutil.copy(base, work)
+		lines = dict((l[0], l[1]) for l in run(program, work, cut, dir, True) if l[0] in ('REOPEN', 'APPEND'))
+		problems, files, contents = check(work)
+		ok = 'APPEND' in lines and not damaged(problems) and 'OVERLONG' not in problems
+		if ok:
+			size = int(lines['REOPEN'])
+			if contents(logName) != logData(size) + appendData(size, 100):
+				ok = False
+		if not ok:
+			print('FAIL: %s %s: append after cut at %d: %s %s' % (base, dir, cut, sorted(problems), lines))
+			fails += 1
+		key = ','.join(sorted(problems)) or 'clean'
+		states[key] = states.get(key, 0) + 1
+	print('%s %s: appending after cuts left %s' % (base, dir, states))
+	os.remove(work)
+	return fails
+
+if __name__ == '__main__':
+	if len(sys.argv) < 3:
+		sys.exit('usage: fatcuttest.py <fatcuttest program> <image>...')
+	fails = 0
+	for image in sys.argv[2:]:
+		for dir in ('-', 'SOUNDS'):
+			fails += testImage(sys.argv[1], image, dir)
+	print('fatcuttest: %d FAILED' % fails if fails else 'fatcuttest: ok')
+	sys.exit(1 if fails else 0)
@@ -0,0 +1,220 @@
+//*****************************************************************************
+//
+// File Name	: 'flashlogtest.c'
+// Title		: Host test for the flash log
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: PC (Linux, for testing)
+// Editor Tabs	: 4
+//
+// Runs flashlog.c on the NOR flash emulated by flashlogsim.c: appends past
+// the end of the flash, remounts, trims and clears, and then cuts the power
+// 3000 times at random program/erase operations.  After every cut the log
+// must remount with all acknowledged records, in order, and nothing may be
+// programmed over bits that were not erased.
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+#include "flashlog.h"
+
+#define SECTORS		8
+#define CUTS		3000
+
+static FlashLog Log;
+static int Fails;
+
+#define CHECK(c)	do { if(!(c)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #c); Fails++; } } while(0)
+
+// record <id>: the id followed by a length and pattern that depend on it
+static u08 makeRecord(u32 id, u08* rec)
+{
+	u08 len = 4 + (id*7)%60;
+	u08 i;
+
+	memcpy(rec, &id, 4);
+	for(i=4; i<len; i++)
+		rec[i] = (u08)(id + i);
+	return len;
+}
+
+// reads the whole log, checking that every record is intact and that the
+// ids are consecutive; returns the number of records and the first/last id
+static int readLog(u32* first, u32* last)
+{
+	FlashLogCursor c;
+	u08 rec[255], expect[255];
+	s16 len;
+	u32 id, prev = 0;
+	int n = 0;
+
+	flashlogRewind(&Log, &c);
+	while((len = flashlogNext(&Log, &c, rec, sizeof(rec))) >= 0)
+	{
+		memcpy(&id, rec, 4);
+		if((len != makeRecord(id, expect)) || memcmp(rec, expect, len))
+		{
+			printf("FAIL: record %u damaged\n", id);
+			Fails++;
+		}
+		if(n && (id != prev+1))
+		{
+			printf("FAIL: records jump from %u to %u\n", prev, id);
+			Fails++;
+		}
+		if(!n)
+			*first = id;
+		prev = id;
+		n++;
+	}
+	*last = prev;
+	return n;
+}
+
+// returns the spread of the sector erase counts
+static u32 eraseSpread(void)
+{
+	u32 e, lo = ~0, hi = 0;
+	u08 s;
+
+	for(s=0; s<SECTORS; s++)
+	{
+		e = flashlogGetEraseCount(&Log, s);
+		if(e < lo) lo = e;
+		if(e > hi) hi = e;
+	}
+	printf("  erase counts %u..%u\n", lo, hi);
+	return hi - lo;
+}
+
+static void testAppend(void)
+{
+	u08 rec[255];
+	u32 id, first, last, first2, last2;
+	int n;
+
+	printf("append, wrap and remount\n");
+	CHECK(!flashlogSimOpen(&Log, SECTORS));
+	CHECK(!flashlogMount(&Log));
+	CHECK(readLog(&first, &last) == 0);
+	for(id=1; id<=5000; id++)
+	{
+		CHECK(!flashlogAppend(&Log, rec, makeRecord(id, rec)));
+		if(id == 10)
+		{
+			n = readLog(&first, &last);
+			CHECK((n == 10) && (first == 1) && (last == 10));
+		}
+	}
+	// the oldest sectors have been reused, the newest records are all there
+	n = readLog(&first, &last);
+	printf("  %d records %u..%u\n", n, first, last);
+	CHECK((last == 5000) && (n > 100));
+	flashlogInit(&Log, Log.ops, SECTORS);
+	CHECK(!flashlogMount(&Log));
+	CHECK((readLog(&first2, &last2) == n) && (first2 == first) && (last2 == last));
+	CHECK(eraseSpread() <= 1);
+	CHECK(flashlogSimGetOverwrites(&Log) == 0);
+}
+
+static void testTrim(void)
+{
+	FlashLogCursor c;
+	u08 rec[255];
+	u32 id, first, last;
+	s16 len;
+	int n;
+
+	printf("cursor, trim and clear\n");
+	// a cursor at the end picks up later appends
+	flashlogRewind(&Log, &c);
+	while(flashlogNext(&Log, &c, rec, sizeof(rec)) >= 0);
+	CHECK(!flashlogAppend(&Log, rec, makeRecord(5001, rec)));
+	len = flashlogNext(&Log, &c, rec, sizeof(rec));
+	memcpy(&id, rec, 4);
+	CHECK((len > 0) && (id == 5001));
+	CHECK(flashlogNext(&Log, &c, rec, sizeof(rec)) < 0);
+	// drop everything before the cursor's sector
+	CHECK(!flashlogTrim(&Log, &c));
+	n = readLog(&first, &last);
+	printf("  %d records %u..%u after trim\n", n, first, last);
+	CHECK((last == 5001) && (n < 200));
+	for(id=5002; id<=6000; id++)
+		CHECK(!flashlogAppend(&Log, rec, makeRecord(id, rec)));
+	CHECK(!flashlogClear(&Log));
+	CHECK(readLog(&first, &last) == 0);
+	flashlogInit(&Log, Log.ops, SECTORS);
+	CHECK(!flashlogMount(&Log));
+	CHECK(readLog(&first, &last) == 0);
+	for(id=1; id<=3000; id++)
+		CHECK(!flashlogAppend(&Log, rec, makeRecord(id, rec)));
+	CHECK((readLog(&first, &last) > 0) && (last == 3000));
+	CHECK(eraseSpread() <= 1);
+	flashlogSimClose(&Log);
+}
+
+static void testPowerCuts(void)
+{
+	FlashLogCursor c;
+	u08 rec[255];
+	u32 id, acked, first, last, i;
+	int cut, n;
+
+	printf("%d power cuts\n", CUTS);
+	srand(1);
+	CHECK(!flashlogSimOpen(&Log, SECTORS));
+	CHECK(!flashlogMount(&Log));
+	acked = 0;
+	for(cut=0; (cut < CUTS) && (Fails < 10); cut++)
+	{
+		// append (and now and then trim) until the power goes
+		flashlogSimPowerFail(&Log, 1 + rand()%400);
+		for(id=acked+1; !flashlogAppend(&Log, rec, makeRecord(id, rec)); id++)
+		{
+			acked = id;
+			if(rand()%500 == 0)
+			{
+				flashlogRewind(&Log, &c);
+				for(i=rand()%50; i && (flashlogNext(&Log, &c, rec, sizeof(rec)) >= 0); i--);
+				if(flashlogTrim(&Log, &c))
+					break;
+			}
+		}
+		CHECK(flashlogSimPowerLost(&Log));
+		// power up again: the last acknowledged record must be there,
+		// the one that was cut short may or may not be
+		flashlogSimPowerFail(&Log, 0);
+		flashlogInit(&Log, Log.ops, SECTORS);
+		CHECK(!flashlogMount(&Log));
+		n = readLog(&first, &last);
+		if(!(n > 0 && ((last == acked) || (last == acked+1))))
+		{
+			printf("FAIL: cut %d: %d records %u..%u, %u acknowledged\n", cut, n, first, last, acked);
+			Fails++;
+		}
+		if(last > acked)
+			acked = last;
+	}
+	printf("  last record %u\n", acked);
+	CHECK(flashlogSimGetOverwrites(&Log) == 0);
+	eraseSpread();
+	flashlogSimClose(&Log);
+}
+
+int main(void)
+{
+	testAppend();
+	testTrim();
+	testPowerCuts();
+	printf(Fails ? "flashlogtest: %d FAILED\n" : "flashlogtest: ok\n", Fails);
+	return Fails != 0;
+}
@@ -0,0 +1,134 @@
+# fsck.py - FAT16/FAT32 consistency checker for the FAT host tests
+#
+#	python3 fsck.py <image>
+#
+# Reads the first partition of a disk image without using fat.c, walks every
+# directory and cluster chain, and reports:
+#	FATDIFF			the FAT copies differ
+#	BADCLUSTER		a chain points outside the volume
+#	CROSSLINK		a cluster is in more than one chain
+#	FREEINCHAIN		a chain runs into a free cluster
+#	SIZEPASTCHAIN	a file is longer than its chain
+#	OVERLONG		a chain is longer than its file needs
+#	LOST			a cluster is allocated but in no chain
+# A cut power supply may leave FATDIFF, OVERLONG and LOST (wasted space, but
+# no wrong data); the others mean files have been damaged.
+
+import struct, sys
+
+SECTOR = 512
+DAMAGE = ('BADCLUSTER', 'CROSSLINK', 'FREEINCHAIN', 'SIZEPASTCHAIN')
+
+class Volume:
+	def __init__(self, path):
+		img = self.img = open(path, 'rb').read()
+		partType = img[0x1BE+4]
+		start = struct.unpack_from('<I', img, 0x1BE+8)[0]
+		bs = start*SECTOR
+		bps, spc, reserved, nfats, rootEntries, total16, media, fatSectors16 = \
+			struct.unpack_from('<HBHBHHBH', img, bs+11)
+		total = total16 or struct.unpack_from('<I', img, bs+32)[0]
+		self.fat32 = partType in (0x0B, 0x0C)
+		self.fatSectors = struct.unpack_from('<I', img, bs+36)[0] if self.fat32 else fatSectors16
+		self.rootCluster = struct.unpack_from('<I', img, bs+44)[0] if self.fat32 else 0
+		self.spc = spc
+		self.nfats = nfats
+		self.firstFat = start + reserved
+		self.firstRoot = self.firstFat + nfats*self.fatSectors
+		self.rootSectors = (rootEntries*32 + SECTOR-1) // SECTOR
+		self.firstData = self.firstRoot + self.rootSectors
+		self.clusters = (start + total - self.firstData) // spc
+		self.eoc = 0x0FFFFFF8 if self.fat32 else 0xFFF8
+		self.bad = 0x0FFFFFF7 if self.fat32 else 0xFFF7
+
+	def fat(self, k):
+		o = (self.firstFat + k*self.fatSectors)*SECTOR
+		n = self.clusters + 2
+		if self.fat32:
+			return [v & 0x0FFFFFFF for v in struct.unpack_from('<%dI' % n, self.img, o)]
+		return list(struct.unpack_from('<%dH' % n, self.img, o))
+
+	def readChain(self, chain):
+		s = self.spc*SECTOR
+		o = self.firstData*SECTOR - 2*s
+		return b''.join(self.img[o + c*s:o + (c+1)*s] for c in chain)
+
+# checks the image; returns the set of problems found, a dictionary of
+# files (path: (size, chain)), and a function returning a file's contents
+def check(path):
+	v = Volume(path)
+	fat = v.fat(0)
+	problems = set()
+	owner = {}
+	files = {}
+
+	for k in range(1, v.nfats):
+		if v.fat(k) != fat:
+			problems.add('FATDIFF')
+
+	def chain(c, name):
+		out = []
+		while True:
+			if c < 2 or c >= v.clusters + 2:
+				problems.add('BADCLUSTER')
+				break
+			if c in owner:
+				problems.add('CROSSLINK')
+				break
+			owner[c] = name
+			out.append(c)
+			if fat[c] >= v.eoc:
+				break
+			if fat[c] == 0:
+				problems.add('FREEINCHAIN')
+				break
+			c = fat[c]
+		return out
+
+	def readDir(data, path):
+		for i in range(0, len(data), 32):
+			e = data[i:i+32]
+			if e[0] == 0:
+				break
+			if e[0] == 0xE5 or e[11] == 0x0F:
+				continue
+			name = e[0:8].decode('latin-1').rstrip()
+			if e[8] != 0x20:
+				name += '.' + e[8:11].decode('latin-1').rstrip()
+			if name in ('.', '..'):
+				continue
+			cluster = struct.unpack_from('<H', e, 26)[0] | (struct.unpack_from('<H', e, 20)[0] << 16)
+			size = struct.unpack_from('<I', e, 28)[0]
+			full = path + '/' + name
+			if e[11] & 0x10:
+				readDir(v.readChain(chain(cluster, full)), full)
+			else:
+				c = chain(cluster, full) if cluster else []
+				need = (size + v.spc*SECTOR-1) // (v.spc*SECTOR)
+				if len(c) < need:
+					problems.add('SIZEPASTCHAIN')
+				elif len(c) > need:
+					problems.add('OVERLONG')
+				files[full] = (size, c)
+
+	if v.fat32:
+		readDir(v.readChain(chain(v.rootCluster, '/')), '')
+	else:
+		readDir(v.img[v.firstRoot*SECTOR:(v.firstRoot + v.rootSectors)*SECTOR], '')
+	for c in range(2, v.clusters + 2):
+		if fat[c] and fat[c] != v.bad and c not in owner:
+			problems.add('LOST')
+			break
+
+	def contents(full):
+		size, c = files[full]
+		return v.readChain(c)[:size]
+
+	return problems, files, contents
+
+if __name__ == '__main__':
+	if len(sys.argv) != 2:
+		sys.exit('usage: fsck.py <image>')
+	problems, files, contents = check(sys.argv[1])
+	print('%s: %d files, %s' % (sys.argv[1], len(files), ' '.join(sorted(problems)) or 'clean'))
+	sys.exit(1 if problems & set(DAMAGE) else 0)
@@ -0,0 +1,4 @@
+// Host stand-in for <avr/interrupt.h>: the modules under test use no interrupts
+#ifndef HOST_INTERRUPT_H
+#define HOST_INTERRUPT_H
+#endif
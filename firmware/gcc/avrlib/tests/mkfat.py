@@ -0,0 +1,158 @@
+# mkfat.py - builds partitioned FAT16/FAT32 disk images for the FAT host tests
+#
+#	python3 mkfat.py fat16|fat32 <image>
+#
+# The volume starts at a sector that is not a multiple of the cluster size,
+# and its clusters are handed out in random order, so that file chains are
+# fragmented and end with assorted end-of-chain values.  The root directory
+# holds empty files with and without long names, among deleted slots.  The
+# SOUNDS subdirectory (spanning several clusters) holds files of 1 to 3
+# clusters whose byte at offset pos is (start cluster * 7 + pos) & 0xFF.
+
+import random, struct, sys
+
+SECTOR = 512
+
+# geometry: FAT32, sectors per cluster, volume start, volume size, root files, SOUNDS files
+GEOMETRY = {
+	'fat16': (False, 4, 63, 8000, 60, 200),
+	'fat32': (True, 8, 8, 16000, 100, 200),
+}
+
+def lfnChecksum(shortName):
+	s = 0
+	for c in shortName:
+		s = ((((s & 1) << 7) | (s >> 1)) + c) & 0xFF
+	return s
+
+def fileData(cluster, size):
+	return bytes((cluster*7 + pos) & 0xFF for pos in range(size))
+
+class Volume:
+	def __init__(self, fat32, spc, start, total, seed):
+		self.fat32 = fat32
+		self.spc = spc
+		self.start = start
+		self.total = total
+		self.reserved = 32 if fat32 else 4
+		self.rootEntries = 0 if fat32 else 512
+		self.rootSectors = self.rootEntries*32 // SECTOR
+		self.fatSectors = ((total//spc + 2)*(4 if fat32 else 2) + SECTOR-1) // SECTOR
+		self.firstFat = start + self.reserved
+		self.firstRoot = self.firstFat + 2*self.fatSectors
+		self.firstData = self.firstRoot + self.rootSectors
+		self.clusters = (start + total - self.firstData) // spc
+		self.eoc = 0x0FFFFFF8 if fat32 else 0xFFF8
+		self.image = bytearray((start + total)*SECTOR)
+		self.fat = [0]*(self.clusters + 2)
+		self.fat[0] = self.eoc
+		self.fat[1] = 0x0FFFFFFF if fat32 else 0xFFFF
+		self.rnd = random.Random(seed)
+		self.free = list(range(2, self.clusters + 2))
+		self.rnd.shuffle(self.free)
+
+	def clusterBytes(self):
+		return self.spc*SECTOR
+
+	# takes n clusters in random order and links them
+	def alloc(self, n):
+		chain = [self.free.pop() for i in range(n)]
+		for a, b in zip(chain, chain[1:]):
+			self.fat[a] = b
+		self.fat[chain[-1]] = self.eoc + self.rnd.randrange(8)
+		return chain
+
+	def writeChain(self, chain, data):
+		cb = self.clusterBytes()
+		for i, c in enumerate(chain):
+			chunk = data[i*cb:(i+1)*cb]
+			o = (self.firstData + (c-2)*self.spc)*SECTOR
+			self.image[o:o+len(chunk)] = chunk
+
+	# directory slots for (long name or None, 8.3 name, attributes, cluster, size)
+	def dirSlots(self, entries, deleted=True):
+		out = bytearray()
+		for i, (longName, shortName, attr, cluster, size) in enumerate(entries):
+			if deleted and i % 7 == 3:
+				slot = bytearray(32)
+				slot[0] = 0xE5
+				slot[11] = 0x20
+				out += slot
+			if longName:
+				chk = lfnChecksum(shortName)
+				n = (len(longName) + 12) // 13
+				u = longName.encode('utf-16-le') + b'\0\0'
+				u += b'\xff'*(n*26 - len(u))
+				for k in range(n, 0, -1):
+					part = u[(k-1)*26:k*26]
+					out += bytes([k | (0x40 if k == n else 0)]) + part[0:10] + bytes([0x0F, 0, chk]) \
+						+ part[10:22] + b'\0\0' + part[22:26]
+			out += struct.pack('<11sBBBHHHHHHHI', shortName, attr, 0, 0, 0x6000+i, 0x5000+i, 0,
+				cluster >> 16, 0, 0, cluster & 0xFFFF, size)
+		return out
+
+	def finish(self, rootCluster):
+		fat = b''.join(struct.pack('<I' if self.fat32 else '<H', v) for v in self.fat)
+		for k in range(2):
+			o = (self.firstFat + k*self.fatSectors)*SECTOR
+			self.image[o:o+len(fat)] = fat
+		# partition table
+		mbr = bytearray(SECTOR)
+		mbr[0x1BE:0x1BE+16] = struct.pack('<BBHBBHII', 0, 0, 0, 0x0C if self.fat32 else 0x06, 0, 0,
+			self.start, self.total)
+		mbr[510:512] = b'\x55\xaa'
+		self.image[0:SECTOR] = mbr
+		# boot sector
+		bs = bytearray(SECTOR)
+		bpb = struct.pack('<HBHBHHBHHHII', SECTOR, self.spc, self.reserved, 2, self.rootEntries, 0, 0xF8,
+			0 if self.fat32 else self.fatSectors, 63, 255, self.start, self.total)
+		if self.fat32:
+			bpb += struct.pack('<IHHIHH', self.fatSectors, 0, 0, rootCluster, 1, 6)
+		bs[11:11+len(bpb)] = bpb
+		bs[510:512] = b'\x55\xaa'
+		o = self.start*SECTOR
+		self.image[o:o+SECTOR] = bs
+
+def shortName(prefix, i):
+	return b'%s%07d' % (prefix, i) + b'TXT'
+
+def build(kind, path):
+	fat32, spc, start, total, rootFiles, subFiles = GEOMETRY[kind]
+	v = Volume(fat32, spc, start, total, 1 if kind == 'fat16' else 2)
+	cb = v.clusterBytes()
+
+	# SOUNDS: files first, then the directory that lists them
+	entries = []
+	for i in range(subFiles):
+		longName = (None, 'alarm sound number %d long name.wav' % i, 'Tone_%d.raw' % i)[i % 3]
+		size = v.rnd.randrange(1, 3*cb)
+		chain = v.alloc((size + cb-1) // cb)
+		v.writeChain(chain, fileData(chain[0], size))
+		entries.append((longName, shortName(b'S', i), 0x20, chain[0], size))
+	body = v.dirSlots(entries)
+	n = (len(body) + 64 + cb-1) // cb + 1
+	subdir = v.alloc(n)
+	dots = [(None, b'.          ', 0x10, subdir[0], 0), (None, b'..         ', 0x10, 0, 0)]
+	v.writeChain(subdir, v.dirSlots(dots, False) + body)
+
+	# root directory
+	entries = [(None, b'SOUNDS     ', 0x10, subdir[0], 0)]
+	for i in range(rootFiles):
+		entries.append(('Root file %d.txt' % i if i % 2 else None, shortName(b'R', i), 0x20, 0, 0))
+	root = v.dirSlots(entries)
+	if fat32:
+		rootChain = v.alloc((len(root) + cb-1) // cb + 1)
+		v.writeChain(rootChain, root)
+		v.finish(rootChain[0])
+	else:
+		assert len(root) <= v.rootSectors*SECTOR
+		o = v.firstRoot*SECTOR
+		v.image[o:o+len(root)] = root
+		v.finish(0)
+	with open(path, 'wb') as f:
+		f.write(v.image)
+
+if __name__ == '__main__':
+	if len(sys.argv) != 3 or sys.argv[1] not in GEOMETRY:
+		sys.exit('usage: mkfat.py fat16|fat32 <image>')
+	build(sys.argv[1], sys.argv[2])
@@ -0,0 +1,199 @@
+//*****************************************************************************
+//
+// File Name	: 'rprintftest.c'
+// Title		: Host test for the rprintf number formatting
+// Author		: smartAlarm contributors - Copyright (C) 2026
+// Created		: 10/19/2026
+// Revised		: 10/19/2026
+// Version		: 0.1
+// Target MCU	: PC (Linux, for testing)
+// Editor Tabs	: 4
+//
+// Checks that the division-free digit loops in rprintf.c print exactly what
+// the library-divide loops they replaced printed:
+//	- rprintfDivMod10() against / and % for every 32-bit value
+//	- rprintfNum() against the previous rprintfNum() (kept below) in bases
+//	  2, 7, 8, 10 and 16 for every 16-bit value, signed and unsigned, and for
+//	  32-bit values around every power of two and ten, a stride through the
+//	  whole range and a million random values
+//	- rprintf2RamRom() %d %u %x %o for every 16-bit value and %ld %lu %lx %lo
+//	  for the same 32-bit values, against the C library, which is what the
+//	  previous loops printed for these conversions
+// The one intended difference is %ld of -2147483648: the previous loop
+// negated it in place, got it back unchanged and printed "-(".  It now
+// prints -2147483648.
+//
+// rprintf.c is included so its static helpers can be reached; the makefile
+// builds it with long narrowed to 32 bits, as on the AVR.
+//
+// This code is distributed under the GNU Public License
+//		which can be found at http://www.gnu.org/licenses/gpl.txt
+//
+//*****************************************************************************
+
+#define RPRINTF_COMPLEX
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rprintf.c"
+
+static int Fails;
+static char Out[64], Ref[64];
+
+static void fail(const char* what, long long n, const char* format)
+{
+	if(Fails++ < 10)
+		printf("FAIL: %s %s of %lld: got \"%s\", expected \"%s\"\n", what, format, n, Out, Ref);
+}
+
+// *** refNum ***
+// rprintfNum() as it was before the division-free digit loops,
+// writing to Ref instead of printing
+static void refNum(char base, char numDigits, char isSigned, char padchar, s32 n)
+{
+	char *p, buf[32];
+	u32 x;
+	unsigned char count;
+
+	if( isSigned && (n < 0) )
+		x = -(u32)n;
+	else
+		x = n;
+	count = (numDigits-1)-(isSigned?1:0);
+	p = buf + sizeof (buf);
+	*--p = '\0';
+	*--p = hexchar(x%base); x /= base;
+	while(count--)
+	{
+		if(x != 0)
+		{
+			*--p = hexchar(x%base); x /= base;
+		}
+		else
+			*--p = padchar;
+	}
+	if( isSigned )
+	{
+		if(n < 0)
+			*--p = '-';
+		else if(n > 0)
+			*--p = '+';
+		else
+			*--p = ' ';
+	}
+	memcpy(Ref, p, numDigits);
+	Ref[(int)numDigits] = 0;
+}
+
+static void checkNum(s32 n)
+{
+	static const char base[] = {10, 10, 16, 8, 2, 7};
+	static const char digits[] = {12, 6, 9, 12, 31, 12};
+	static const char pad[] = {' ', '0', '.', '.', '.', '.'};
+	char isSigned;
+	int i;
+
+	for(i=0; i<sizeof(base); i++)
+	{
+		for(isSigned=0; isSigned<2; isSigned++)
+		{
+			rprintfBufferBegin(Out, sizeof(Out));
+			rprintfNum(base[i], digits[i], isSigned, pad[i], n);
+			rprintfBufferEnd();
+			refNum(base[i], digits[i], isSigned, pad[i], n);
+			if(strcmp(Out, Ref))
+				fail("rprintfNum", n, isSigned ? "signed" : "unsigned");
+		}
+	}
+}
+
+// one conversion of rprintf2RamRom() against snprintf()
+// (hostformat is format for the PC's int, which is 32 bits)
+#define CHECK_FORMAT(format, hostformat, value)					\
+	do {														\
+		rprintfBufferBegin(Out, sizeof(Out));					\
+		rprintf2RamRom(STRING_IN_RAM, format, value);			\
+		rprintfBufferEnd();										\
+		snprintf(Ref, sizeof(Ref), hostformat, value);			\
+		if(strcmp(Out, Ref))									\
+			fail("rprintf2RamRom", (long long)(value), format);	\
+	} while(0)
+
+static void check16(int n)
+{
+	checkNum(n);
+	CHECK_FORMAT("%d", "%d", (int)(s16)n);
+	CHECK_FORMAT("%u", "%u", (unsigned)(u16)n);
+	CHECK_FORMAT("%x", "%x", (unsigned)(u16)n);
+	CHECK_FORMAT("%o", "%o", (unsigned)(u16)n);
+}
+
+static void check32(u32 n)
+{
+	checkNum(n);
+	if((s32)n != (s32)0x80000000)
+		CHECK_FORMAT("%ld", "%d", (s32)n);
+	CHECK_FORMAT("%lu", "%u", n);
+	CHECK_FORMAT("%lx", "%x", n);
+	CHECK_FORMAT("%lo", "%o", n);
+	CHECK_FORMAT("%12lu", "%12u", n);
+	CHECK_FORMAT("%-12lu|", "%-12u|", n);
+}
+
+int main(void)
+{
+	u32 n, q, p, i;
+	unsigned char r;
+	int k;
+
+	printf("rprintfDivMod10 over the 32-bit range\n");
+	n = 0;
+	do {
+		q = n;
+		r = rprintfDivMod10(&q);
+		if((q != n/10) || (r != n%10))
+		{
+			if(Fails++ < 10)
+				printf("FAIL: rprintfDivMod10(%u) = %u rem %u\n", n, q, r);
+		}
+	} while(++n);
+
+	printf("16-bit values\n");
+	for(k=-32768; k<65536; k++)
+		check16(k);
+
+	printf("32-bit values\n");
+	for(p=1; p; p<<=1)
+		for(i=0; i<3; i++)
+		{
+			check32(p-1+i);
+			check32(-(p-1+i));
+		}
+	for(p=1; p<=1000000000; p*=10)
+		for(i=0; i<3; i++)
+		{
+			check32(p-1+i);
+			check32(-(p-1+i));
+			check32(p*9-1+i);
+			check32(-(p*9-1+i));
+		}
+	for(n=0; n<0xFFFFFFFF-65521; n+=65521)
+		check32(n);
+	check32(0xFFFFFFFF);
+	srand(1);
+	for(i=0; i<1000000; i++)
+		check32(((u32)rand() << 16) ^ rand());
+
+	// the changed output
+	rprintfBufferBegin(Out, sizeof(Out));
+	rprintf2RamRom(STRING_IN_RAM, "%ld", (s32)0x80000000);
+	rprintfBufferEnd();
+	strcpy(Ref, "-2147483648");
+	if(strcmp(Out, Ref))
+		fail("rprintf2RamRom", (s32)0x80000000, "%ld");
+
+	printf(Fails ? "rprintftest: %d FAILED\n" : "rprintftest: ok\n", Fails);
+	return Fails != 0;
+}
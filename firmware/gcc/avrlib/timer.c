@@ -22,6 +22,7 @@
 
 #include "global.h"
 #include "timer.h"
+#include "isrstat.h"
 
 #include "rprintf.h"
 
@@ -35,50 +36,34 @@ unsigned short __attribute__ ((progmem)) TimerRTCPrescaleFactor[] = {0,1,8,32,64
 
 // Global variables
 // time registers
+// (TimerPauseReg counts timer0 overflows and is never cleared,
+// it is the high part of the monotonic tick count)
 volatile unsigned long TimerPauseReg;
 volatile unsigned long Timer0Reg0;
 volatile unsigned long Timer2Reg0;
 
+#ifndef TIMER_STATIC_DISPATCH
 typedef void (*voidFuncPtr)(void);
 volatile static voidFuncPtr TimerIntFunc[TIMER_NUM_INTERRUPTS];
 
-// delay for a minimum of <us> microseconds 
-// the time resolution is dependent on the time the loop takes 
-// e.g. with 4Mhz and 5 cycles per loop, the resolution is 1.25 us 
-void delay_us(unsigned short time_us) 
-{
-	unsigned short delay_loops;
-	register unsigned short i;
-
-	delay_loops = (time_us+3)/5*CYCLES_PER_US; // +3 for rounding up (dirty) 
+// call the user function attached to a timer interrupt, if any
+#define TIMER_DISPATCH(intNum)	if(TimerIntFunc[intNum]) TimerIntFunc[intNum]()
+#else
+#define TIMER_DISPATCH(intNum)
+#endif
 
-	// one loop takes 5 cpu cycles 
-	for (i=0; i < delay_loops; i++) {};
-}
-/*
-void delay_ms(unsigned char time_ms)
-{
-	unsigned short delay_count = F_CPU / 4000;
+// timer0 tics per millisecond, in 24.8 fixed-point
+// (updated whenever the timer0 prescaler is changed)
+static u32 Timer0TicsPerMsQ8;
 
-	unsigned short cnt;
-	asm volatile ("\n"
-                  "L_dl1%=:\n\t"
-                  "mov %A0, %A2\n\t"
-                  "mov %B0, %B2\n"
-                  "L_dl2%=:\n\t"
-                  "sbiw %A0, 1\n\t"
-                  "brne L_dl2%=\n\t"
-                  "dec %1\n\t" "brne L_dl1%=\n\t":"=&w" (cnt)
-                  :"r"(time_ms), "r"((unsigned short) (delay_count))
-	);
-}
-*/
 void timerInit(void)
 {
+	#ifndef TIMER_STATIC_DISPATCH
 	u08 intNum;
 	// detach all user functions from interrupts
 	for(intNum=0; intNum<TIMER_NUM_INTERRUPTS; intNum++)
 		timerDetach(intNum);
+	#endif
 
 	// initialize all timers
 	timer0Init();
@@ -123,8 +108,24 @@ void timer2Init(void)
 
 void timer0SetPrescaler(u08 prescale)
 {
+	u32 ticsPerMsQ8;
+	u16 prescaleDiv;
+
 	// set prescaler on timer 0
 	outb(TCCR0, (inb(TCCR0) & ~TIMER_PRESCALE_MASK) | prescale);
+
+	// work out the tic rate once here, so that pauses need no division
+	// (prescale factors are powers of two, so divide by shifting)
+	ticsPerMsQ8 = ((F_CPU/1000)<<8) + (((F_CPU%1000)<<8)/1000);
+	prescaleDiv = timer0GetPrescaler();
+	if(prescaleDiv)
+	{
+		while(prescaleDiv >>= 1)
+			ticsPerMsQ8 >>= 1;
+	}
+	else
+		ticsPerMsQ8 = 0;	// stopped or external clock
+	Timer0TicsPerMsQ8 = ticsPerMsQ8;
 }
 
 void timer1SetPrescaler(u08 prescale)
@@ -164,6 +165,7 @@ u16 timer2GetPrescaler(void)
 }
 #endif
 
+#ifndef TIMER_STATIC_DISPATCH
 void timerAttach(u08 interruptNum, void (*userFunc)(void) )
 {
 	// make sure the interrupt number is within bounds
@@ -184,66 +186,75 @@ void timerDetach(u08 interruptNum)
 		TimerIntFunc[interruptNum] = 0;
 	}
 }
-/*
-u32 timerMsToTics(u16 ms)
-{
-	// calculate the prescaler division rate
-	u16 prescaleDiv = 1<<(pgm_read_byte(TimerPrescaleFactor+inb(TCCR0)));
-	// calculate the number of timer tics in x milliseconds
-	return (ms*(F_CPU/(prescaleDiv*256)))/1000;
+#endif
+u32 timer0GetTics(void)
+{
+	u08 sreg;
+	u08 lo;
+	u32 hi;
+
+	// read overflow count and TCNT0 together
+	sreg = SREG;
+	cli();
+	lo = inb(TCNT0);
+	hi = TimerPauseReg;
+	// an overflow that has not been serviced yet belongs to the count
+	if(inb(TIFR) & BV(TOV0))
+	{
+		lo = inb(TCNT0);
+		hi++;
+	}
+	SREG = sreg;
+
+	return (hi<<8) | lo;
 }
 
-u16 timerTicsToMs(u32 tics)
+u32 timerMsToTics(u16 ms)
 {
-	// calculate the prescaler division rate
-	u16 prescaleDiv = 1<<(pgm_read_byte(TimerPrescaleFactor+inb(TCCR0)));
-	// calculate the number of milliseconds in x timer tics
-	return (tics*1000*(prescaleDiv*256))/F_CPU;
+	u32 ticsPerMsQ8 = Timer0TicsPerMsQ8;
+
+	// integer and fractional parts multiplied separately
+	// so the product cannot overflow for any ms and F_CPU
+	return (ms*(ticsPerMsQ8>>8)) + ((ms*(ticsPerMsQ8&0xFF))>>8);
 }
-*/
-void timerPause(unsigned short pause_ms)
+
+void timerPauseUntil(u32 deadline)
 {
-	// pauses for exactly <pause_ms> number of milliseconds
-	u08 timerThres;
-	u32 ticRateHz;
-	u32 pause;
-
-	// capture current pause timer value
-	timerThres = inb(TCNT0);
-	// reset pause timer overflow count
-	TimerPauseReg = 0;
-	// calculate delay for [pause_ms] milliseconds
-	// prescaler division = 1<<(pgm_read_byte(TimerPrescaleFactor+inb(TCCR0)))
-	ticRateHz = F_CPU/timer0GetPrescaler();
-	// precision management
-	// prevent overflow and precision underflow
-	//	-could add more conditions to improve accuracy
-	if( ((ticRateHz < 429497) && (pause_ms <= 10000)) )
-		pause = (pause_ms*ticRateHz)/1000;
-	else
-		pause = pause_ms*(ticRateHz/1000);
+	s32 remaining;
+
+	set_sleep_mode(SLEEP_MODE_IDLE);
 
 	// loop until time expires
-	while( ((TimerPauseReg<<8) | inb(TCNT0)) < (pause+timerThres) )
+	// (the signed difference keeps this right when the tic count wraps)
+	for(;;)
 	{
-		if( TimerPauseReg < (pause>>8));
+		cli();
+		remaining = deadline - timer0GetTics();
+		if(remaining <= 0)
+			break;
+		if(remaining > 256)
 		{
-			// save power by idling the processor
-			set_sleep_mode(SLEEP_MODE_IDLE);
-			sleep_mode();
+			// the next timer0 overflow comes before the deadline, so
+			// save power by idling the processor until then
+			// (sei takes effect after sleep, so the wake-up can't be missed)
+			sleep_enable();
+			sei();
+			sleep_cpu();
+			sleep_disable();
+		}
+		else
+		{
+			// less than one overflow period left, spin out the rest
+			sei();
 		}
 	}
+	sei();
+}
 
-	/* old inaccurate code, for reference
-	
-	// calculate delay for [pause_ms] milliseconds
-	u16 prescaleDiv = 1<<(pgm_read_byte(TimerPrescaleFactor+inb(TCCR0)));
-	u32 pause = (pause_ms*(F_CPU/(prescaleDiv*256)))/1000;
-	
-	TimerPauseReg = 0;
-	while(TimerPauseReg < pause);
-
-	*/
+void timerPause(unsigned short pause_ms)
+{
+	// pauses for exactly <pause_ms> number of milliseconds
+	timerPauseUntil(timer0GetTics() + timerMsToTics(pause_ms));
 }
 
 void timer0ClearOverflowCount(void)
@@ -395,33 +406,45 @@ void timer1PWMBSet(u16 pwmDuty)
 //! Interrupt handler for tcnt0 overflow interrupt
 TIMER_INTERRUPT_HANDLER(SIG_OVERFLOW0)
 {
+	ISRSTAT_ENTER(ISRSTAT_TIMER0OVF);
 	Timer0Reg0++;			// increment low-order counter
 
 	// increment pause counter
 	TimerPauseReg++;
 
-	// if a user function is defined, execute it too
-	if(TimerIntFunc[TIMER0OVERFLOW_INT])
-		TimerIntFunc[TIMER0OVERFLOW_INT]();
+	// run the handler bound at build time, or the attached user function
+	#ifdef TIMER0OVERFLOW_HANDLER
+	TIMER0OVERFLOW_HANDLER();
+	#else
+	TIMER_DISPATCH(TIMER0OVERFLOW_INT);
+	#endif
 }
 
 //! Interrupt handler for tcnt1 overflow interrupt
 TIMER_INTERRUPT_HANDLER(SIG_OVERFLOW1)
 {
-	// if a user function is defined, execute it
-	if(TimerIntFunc[TIMER1OVERFLOW_INT])
-		TimerIntFunc[TIMER1OVERFLOW_INT]();
+	ISRSTAT_ENTER(ISRSTAT_TIMER1OVF);
+	// run the handler bound at build time, or the attached user function
+	#ifdef TIMER1OVERFLOW_HANDLER
+	TIMER1OVERFLOW_HANDLER();
+	#else
+	TIMER_DISPATCH(TIMER1OVERFLOW_INT);
+	#endif
 }
 
 #ifdef TCNT2	// support timer2 only if it exists
 //! Interrupt handler for tcnt2 overflow interrupt
 TIMER_INTERRUPT_HANDLER(SIG_OVERFLOW2)
 {
+	ISRSTAT_ENTER(ISRSTAT_TIMER2OVF);
 	Timer2Reg0++;			// increment low-order counter
 
-	// if a user function is defined, execute it
-	if(TimerIntFunc[TIMER2OVERFLOW_INT])
-		TimerIntFunc[TIMER2OVERFLOW_INT]();
+	// run the handler bound at build time, or the attached user function
+	#ifdef TIMER2OVERFLOW_HANDLER
+	TIMER2OVERFLOW_HANDLER();
+	#else
+	TIMER_DISPATCH(TIMER2OVERFLOW_INT);
+	#endif
 }
 #endif
 
@@ -430,40 +453,62 @@ TIMER_INTERRUPT_HANDLER(SIG_OVERFLOW2)
 //! Interrupt handler for OutputCompare0 match (OC0) interrupt
 TIMER_INTERRUPT_HANDLER(SIG_OUTPUT_COMPARE0)
 {
-	// if a user function is defined, execute it
-	if(TimerIntFunc[TIMER0OUTCOMPARE_INT])
-		TimerIntFunc[TIMER0OUTCOMPARE_INT]();
+	ISRSTAT_ENTER(ISRSTAT_TIMER0COMP);
+	// run the handler bound at build time, or the attached user function
+	#ifdef TIMER0OUTCOMPARE_HANDLER
+	TIMER0OUTCOMPARE_HANDLER();
+	#else
+	TIMER_DISPATCH(TIMER0OUTCOMPARE_INT);
+	#endif
 }
 #endif
 
+#ifndef PROFILER	// the profiler (prof.c) has its own OC1A handler
 //! Interrupt handler for CutputCompare1A match (OC1A) interrupt
 TIMER_INTERRUPT_HANDLER(SIG_OUTPUT_COMPARE1A)
 {
-	// if a user function is defined, execute it
-	if(TimerIntFunc[TIMER1OUTCOMPAREA_INT])
-		TimerIntFunc[TIMER1OUTCOMPAREA_INT]();
+	ISRSTAT_ENTER(ISRSTAT_TIMER1COMPA);
+	// run the handler bound at build time, or the attached user function
+	#ifdef TIMER1OUTCOMPAREA_HANDLER
+	TIMER1OUTCOMPAREA_HANDLER();
+	#else
+	TIMER_DISPATCH(TIMER1OUTCOMPAREA_INT);
+	#endif
 }
+#endif
 
 //! Interrupt handler for OutputCompare1B match (OC1B) interrupt
 TIMER_INTERRUPT_HANDLER(SIG_OUTPUT_COMPARE1B)
 {
-	// if a user function is defined, execute it
-	if(TimerIntFunc[TIMER1OUTCOMPAREB_INT])
-		TimerIntFunc[TIMER1OUTCOMPAREB_INT]();
+	ISRSTAT_ENTER(ISRSTAT_TIMER1COMPB);
+	// run the handler bound at build time, or the attached user function
+	#ifdef TIMER1OUTCOMPAREB_HANDLER
+	TIMER1OUTCOMPAREB_HANDLER();
+	#else
+	TIMER_DISPATCH(TIMER1OUTCOMPAREB_INT);
+	#endif
 }
 
 //! Interrupt handler for InputCapture1 (IC1) interrupt
 TIMER_INTERRUPT_HANDLER(SIG_INPUT_CAPTURE1)
 {
-	// if a user function is defined, execute it
-	if(TimerIntFunc[TIMER1INPUTCAPTURE_INT])
-		TimerIntFunc[TIMER1INPUTCAPTURE_INT]();
+	ISRSTAT_ENTER(ISRSTAT_TIMER1CAPT);
+	// run the handler bound at build time, or the attached user function
+	#ifdef TIMER1INPUTCAPTURE_HANDLER
+	TIMER1INPUTCAPTURE_HANDLER();
+	#else
+	TIMER_DISPATCH(TIMER1INPUTCAPTURE_INT);
+	#endif
 }
 
 //! Interrupt handler for OutputCompare2 match (OC2) interrupt
 TIMER_INTERRUPT_HANDLER(SIG_OUTPUT_COMPARE2)
 {
-	// if a user function is defined, execute it
-	if(TimerIntFunc[TIMER2OUTCOMPARE_INT])
-		TimerIntFunc[TIMER2OUTCOMPARE_INT]();
+	ISRSTAT_ENTER(ISRSTAT_TIMER2COMP);
+	// run the handler bound at build time, or the attached user function
+	#ifdef TIMER2OUTCOMPARE_HANDLER
+	TIMER2OUTCOMPARE_HANDLER();
+	#else
+	TIMER_DISPATCH(TIMER2OUTCOMPARE_INT);
+	#endif
 }
@@ -70,6 +70,7 @@
 #define TIMER_H
 
 #include "global.h"
+#include "delay.h"
 
 // constants/macros/typdefs
 
@@ -183,9 +184,9 @@
 #endif
 
 // functions
+// (delay_us() and delay_ms_busy() busy-waits are provided by delay.h)
 #define delay		delay_us
 #define delay_ms	timerPause
-void delay_us(unsigned short time_us);
 
 //! initializes timing system (all timers)
 // runs all timer init functions
@@ -236,17 +237,63 @@ u16  timer2GetPrescaler(void);				///< get timer2 prescaler
 //
 //		void myOverflowFunction(void) { ... }
 
+// Build-time binding
+//		Calling an attached function through the table costs the interrupt
+//		a pointer load and makes it save every call-clobbered register.  A
+//		function can instead be bound to an interrupt at build time by
+//		defining <interrupt>_HANDLER in your project's global.h, e.g.
+//
+//		void mySystick(void);
+//		#define TIMER2OVERFLOW_HANDLER		mySystick
+//
+//		The interrupt then calls mySystick() directly (a static inline
+//		function declared in a header included from global.h, or building
+//		with -flto, lets the compiler inline it).  The available names are
+//		TIMER0OVERFLOW_HANDLER, TIMER1OVERFLOW_HANDLER, TIMER2OVERFLOW_HANDLER,
+//		TIMER0OUTCOMPARE_HANDLER, TIMER1OUTCOMPAREA_HANDLER,
+//		TIMER1OUTCOMPAREB_HANDLER, TIMER1INPUTCAPTURE_HANDLER and
+//		TIMER2OUTCOMPARE_HANDLER.  Interrupts without a bound function still
+//		use timerAttach(), unless TIMER_STATIC_DISPATCH is also defined, which
+//		removes the table and timerAttach()/timerDetach() altogether.
+
+#ifndef TIMER_STATIC_DISPATCH
 //! Attach a user function to a timer interrupt
 void timerAttach(u08 interruptNum, void (*userFunc)(void) );
 //! Detach a user function from a timer interrupt
 void timerDetach(u08 interruptNum);
+#endif
 
 
 // timing commands
 /// A timer-based delay/pause function
 /// @param pause_ms	Number of integer milliseconds to wait.
+/// The processor idles (sleeps) between timer0 overflows while waiting.
 void timerPause(unsigned short pause_ms);
 
+//! Pause until the timer0 tic count reaches \c deadline.
+/// Use this for drift-free periodic loops:
+/// \code
+/// u32 next = timer0GetTics();
+/// for(;;)
+/// {
+///		next += timerMsToTics(10);
+///		timerPauseUntil(next);
+///		...work...
+/// }
+/// \endcode
+/// The deadline must be less than half the tic counter's wrap period
+/// (2^31 tics) ahead.  Interrupts must be enabled.
+void timerPauseUntil(u32 deadline);
+
+//! Returns the monotonic timer0 tic count.
+/// This counts at F_CPU/(timer0 prescale) and is never cleared, so
+/// differences between two readings are elapsed time (modulo 2^32 tics).
+u32 timer0GetTics(void);
+
+//! Converts milliseconds to timer0 tics at the current timer0 prescaler.
+/// Uses no division; the tic rate is computed when the prescaler is set.
+u32 timerMsToTics(u16 ms);
+
 // overflow counters
 void timer0ClearOverflowCount(void);	///< Clear timer0's overflow counter. 
 long timer0GetOverflowCount(void);		///< read timer0's overflow counter
@@ -69,6 +69,7 @@
 #define TIMER128_H
 
 #include "global.h"
+#include "delay.h"
 
 // constants/macros/typdefs
 
@@ -176,9 +177,9 @@
 #endif
 
 // functions
+// (delay_us() and delay_ms_busy() busy-waits are provided by delay.h)
 #define delay		delay_us
 #define delay_ms	timerPause
-void delay_us(unsigned short time_us);
 
 // initializes timing system
 // runs all timer init functions
@@ -40,37 +40,6 @@ volatile unsigned long Timer2Reg0;
 typedef void (*voidFuncPtr)(void);
 volatile static voidFuncPtr TimerIntFunc[TIMER_NUM_INTERRUPTS];
 
-// delay for a minimum of <us> microseconds 
-// the time resolution is dependent on the time the loop takes 
-// e.g. with 4Mhz and 5 cycles per loop, the resolution is 1.25 us 
-void delay_us(unsigned short time_us) 
-{
-	unsigned short delay_loops;
-	register unsigned short i;
-
-	delay_loops = (time_us+3)/5*CYCLES_PER_US; // +3 for rounding up (dirty) 
-
-	// one loop takes 5 cpu cycles 
-	for (i=0; i < delay_loops; i++) {};
-}
-/*
-void delay_ms(unsigned char time_ms)
-{
-	unsigned short delay_count = F_CPU / 4000;
-
-	unsigned short cnt;
-	asm volatile ("\n"
-                  "L_dl1%=:\n\t"
-                  "mov %A0, %A2\n\t"
-                  "mov %B0, %B2\n"
-                  "L_dl2%=:\n\t"
-                  "sbiw %A0, 1\n\t"
-                  "brne L_dl2%=\n\t"
-                  "dec %1\n\t" "brne L_dl1%=\n\t":"=&w" (cnt)
-                  :"r"(time_ms), "r"((unsigned short) (delay_count))
-	);
-}
-*/
 void timerInit(void)
 {
 	u08 intNum;
@@ -70,6 +70,7 @@
 #define TIMER_H
 
 #include "global.h"
+#include "delay.h"
 
 // constants/macros/typdefs
 
@@ -183,9 +184,9 @@
 #endif
 
 // functions
+// (delay_us() and delay_ms_busy() busy-waits are provided by delay.h)
 #define delay		delay_us
 #define delay_ms	timerPause
-void delay_us(unsigned short time_us);
 
 //! initializes timing system (all timers)
 // runs all timer init functions
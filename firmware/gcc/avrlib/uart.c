@@ -20,6 +20,7 @@
 
 #include "buffer.h"
 #include "uart.h"
+#include "isrstat.h"
 
 // UART global variables
 // flag variables
@@ -29,6 +30,13 @@ volatile u08   uartBufferedTx;		///< uartBufferedTx flag
 cBuffer uartRxBuffer;				///< uart receive buffer
 cBuffer uartTxBuffer;				///< uart transmit buffer
 unsigned short uartRxOverflow;		///< receive overflow counter
+#ifdef UART_FLOWCONTROL
+volatile u08   uartFlowMode;		///< flow control mode (UART_FLOW_xxx)
+volatile u08   uartRxThrottled;		///< TRUE when we have asked the sender to stop
+volatile u08   uartTxStopped;		///< TRUE when the remote end has sent XOFF
+volatile u08   uartTxHeld;			///< TRUE when buffered tx is paused by flow control
+volatile u08   uartTxFlowChar;		///< XON/XOFF waiting to be sent (0 if none)
+#endif
 
 #ifndef UART_BUFFERS_EXTERNAL_RAM
 	// using internal ram,
@@ -37,16 +45,29 @@ unsigned short uartRxOverflow;		///< receive overflow counter
 	static char uartTxData[UART_TX_BUFFER_SIZE];
 #endif
 
+#ifndef UART_STATIC_DISPATCH
 typedef void (*voidFuncPtru08)(unsigned char);
 volatile static voidFuncPtru08 UartRxFunc;
+#endif
+
+// byte-stream operations
+const StreamOps uartStreamOps = {uartSendByte, uartGetByte, uartGetRxBuffer, uartFlushReceiveBuffer};
+
+#ifdef UART_FLOWCONTROL
+static void uartRxThrottle(u08 stop);
+static void uartRxRelease(void);
+static void uartTxResume(void);
+#endif
 
 // enable and initialize the uart
 void uartInit(void)
 {
 	// initialize the buffers
 	uartInitBuffers();
+	#ifndef UART_STATIC_DISPATCH
 	// initialize user receive handler
 	UartRxFunc = 0;
+	#endif
 
 	// enable RxD/TxD and interrupts
 	outb(UCR, BV(RXCIE)|BV(TXCIE)|BV(RXEN)|BV(TXEN));
@@ -58,6 +79,10 @@ void uartInit(void)
 	uartBufferedTx = FALSE;
 	// clear overflow count
 	uartRxOverflow = 0;
+	#ifdef UART_FLOWCONTROL
+	// no flow control until requested
+	uartSetFlowControl(UART_FLOW_NONE);
+	#endif
 	// enable interrupts
 	sei();
 }
@@ -78,12 +103,14 @@ void uartInitBuffers(void)
 	#endif
 }
 
+#ifndef UART_STATIC_DISPATCH
 // redirects received data to a user function
 void uartSetRxHandler(void (*rx_func)(unsigned char c))
 {
 	// set the receive interrupt to run the supplied user function
 	UartRxFunc = rx_func;
 }
+#endif
 
 // set the uart baud rate
 void uartSetBaudRate(u32 baudrate)
@@ -110,15 +137,128 @@ cBuffer* uartGetTxBuffer(void)
 	return &uartTxBuffer;
 }
 
+#ifdef UART_FLOWCONTROL
+// select the flow control mode
+void uartSetFlowControl(u08 mode)
+{
+	u08 sreg = SREG;
+	cli();
+	uartFlowMode = mode;
+	// reset flow control state
+	uartRxThrottled = FALSE;
+	uartTxStopped = FALSE;
+	uartTxHeld = FALSE;
+	uartTxFlowChar = 0;
+	if(mode & UART_FLOW_RTSCTS)
+	{
+		// RTS is an output, asserted (low) to accept data
+		cbi(UART_RTS_PORT, UART_RTS_PIN);
+		sbi(UART_RTS_DDR, UART_RTS_PIN);
+		// CTS is an input
+		cbi(UART_CTS_DDR, UART_CTS_PIN);
+	}
+	SREG = sreg;
+}
+
+// returns TRUE if the remote end has asked us to stop sending
+static u08 uartTxIsStopped(void)
+{
+	if((uartFlowMode & UART_FLOW_XONXOFF) && uartTxStopped)
+		return TRUE;
+	if((uartFlowMode & UART_FLOW_RTSCTS) && (inb(UART_CTS_PORTIN) & BV(UART_CTS_PIN)))
+		return TRUE;
+	return FALSE;
+}
+
+// queue an XON/XOFF character ahead of any other transmit data
+// (must be called with interrupts disabled)
+static void uartSendFlowChar(u08 c)
+{
+	if(uartReadyTx || uartTxHeld)
+	{
+		// transmitter is idle, send it now
+		// the transmit interrupt takes care of any held buffer
+		outb(UDR, c);
+		uartReadyTx = FALSE;
+		uartTxHeld = FALSE;
+	}
+	else
+	{
+		// send it as soon as the current byte is done
+		uartTxFlowChar = c;
+	}
+}
+
+// ask the sender to stop (TRUE) or resume (FALSE)
+// (must be called with interrupts disabled)
+static void uartRxThrottle(u08 stop)
+{
+	uartRxThrottled = stop;
+	if(uartFlowMode & UART_FLOW_RTSCTS)
+	{
+		if(stop)
+			sbi(UART_RTS_PORT, UART_RTS_PIN);
+		else
+			cbi(UART_RTS_PORT, UART_RTS_PIN);
+	}
+	if(uartFlowMode & UART_FLOW_XONXOFF)
+		uartSendFlowChar(stop?UART_XOFF:UART_XON);
+}
+
+// let the sender resume once the receive buffer has drained
+static void uartRxRelease(void)
+{
+	u08 sreg = SREG;
+	cli();
+	if(uartRxThrottled && (uartRxBuffer.datalength <= UART_RX_LOW_WATER))
+		uartRxThrottle(FALSE);
+	SREG = sreg;
+}
+
+// restart buffered transmission paused by flow control
+static void uartTxResume(void)
+{
+	u08 sreg = SREG;
+	cli();
+	if(uartTxHeld && !uartTxIsStopped())
+	{
+		uartTxHeld = FALSE;
+		outb(UDR, bufferGetFromFront(&uartTxBuffer));
+	}
+	SREG = sreg;
+}
+#endif
+
 // transmits a byte over the uart
 void uartSendByte(u08 txData)
 {
+	#ifdef UART_FLOWCONTROL
+	u08 sreg;
+	for(;;)
+	{
+		// wait for the transmitter to be ready and the remote end to accept data
+		while(!uartReadyTx || uartTxIsStopped());
+		// claim the transmitter atomically,
+		// the receive interrupt may use it to send XON/XOFF
+		sreg = SREG;
+		cli();
+		if(uartReadyTx)
+			break;
+		SREG = sreg;
+	}
+	// send byte
+	outb(UDR, txData);
+	// set ready state to FALSE
+	uartReadyTx = FALSE;
+	SREG = sreg;
+	#else
 	// wait for the transmitter to be ready
 	while(!uartReadyTx);
 	// send byte
 	outb(UDR, txData);
 	// set ready state to FALSE
 	uartReadyTx = FALSE;
+	#endif
 }
 
 // gets a single byte from the uart receive buffer (getchar-style)
@@ -134,6 +274,10 @@ int uartGetByte(void)
 // gets a byte (if available) from the uart receive buffer
 u08 uartReceiveByte(u08* rxData)
 {
+	#ifdef UART_FLOWCONTROL
+	// restart transmission if CTS has come back
+	uartTxResume();
+	#endif
 	// make sure we have a receive buffer
 	if(uartRxBuffer.size)
 	{
@@ -142,6 +286,10 @@ u08 uartReceiveByte(u08* rxData)
 		{
 			// get byte from beginning of buffer
 			*rxData = bufferGetFromFront(&uartRxBuffer);
+			#ifdef UART_FLOWCONTROL
+			// let the sender resume if we have made enough room
+			uartRxRelease();
+			#endif
 			return TRUE;
 		}
 		else
@@ -164,6 +312,9 @@ void uartFlushReceiveBuffer(void)
 	//bufferFlush(&uartRxBuffer);
 	// same effect as above
 	uartRxBuffer.datalength = 0;
+	#ifdef UART_FLOWCONTROL
+	uartRxRelease();
+	#endif
 }
 
 // return true if uart receive buffer is empty
@@ -189,6 +340,14 @@ u08 uartAddToTxBuffer(u08 data)
 // start transmission of the current uart Tx buffer contents
 void uartSendTxBuffer(void)
 {
+	#ifdef UART_FLOWCONTROL
+	// buffered transmit is already running (paused by flow control)
+	if(uartBufferedTx)
+	{
+		uartTxResume();
+		return;
+	}
+	#endif
 	// turn on buffered transmit
 	uartBufferedTx = TRUE;
 	// send the first byte to get things going by interrupts
@@ -229,12 +388,30 @@ u08 uartSendBuffer(char *buffer, u16 nBytes)
 // UART Transmit Complete Interrupt Handler
 UART_INTERRUPT_HANDLER(SIG_UART_TRANS)
 {
+	ISRSTAT_ENTER(ISRSTAT_UART_TX);
+	#ifdef UART_FLOWCONTROL
+	// flow control characters go out ahead of any other data
+	if(uartTxFlowChar)
+	{
+		outb(UDR, uartTxFlowChar);
+		uartTxFlowChar = 0;
+		return;
+	}
+	#endif
 	// check if buffered tx is enabled
 	if(uartBufferedTx)
 	{
 		// check if there's data left in the buffer
 		if(uartTxBuffer.datalength)
 		{
+			#ifdef UART_FLOWCONTROL
+			// hold the buffer if the remote end is not ready
+			if(uartTxIsStopped())
+			{
+				uartTxHeld = TRUE;
+				return;
+			}
+			#endif
 			// send byte from top of buffer
 			outb(UDR, bufferGetFromFront(&uartTxBuffer));
 		}
@@ -257,11 +434,35 @@ UART_INTERRUPT_HANDLER(SIG_UART_TRANS)
 // UART Receive Complete Interrupt Handler
 UART_INTERRUPT_HANDLER(SIG_UART_RECV)
 {
+	ISRSTAT_ENTER(ISRSTAT_UART_RX);
 	u08 c;
 	
 	// get received char
 	c = inb(UDR);
 
+	#ifdef UART_FLOWCONTROL
+	// intercept XON/XOFF from the remote end
+	if(uartFlowMode & UART_FLOW_XONXOFF)
+	{
+		if(c == UART_XOFF)
+		{
+			uartTxStopped = TRUE;
+			return;
+		}
+		if(c == UART_XON)
+		{
+			uartTxStopped = FALSE;
+			uartTxResume();
+			return;
+		}
+	}
+	#endif
+
+	#ifdef UART_RX_HANDLER
+	// pass the received data to the handler bound at build time
+	UART_RX_HANDLER(c);
+	#else
+	#ifndef UART_STATIC_DISPATCH
 	// if there's a user function to handle this receive event
 	if(UartRxFunc)
 	{
@@ -269,6 +470,7 @@ UART_INTERRUPT_HANDLER(SIG_UART_RECV)
 		UartRxFunc(c);
 	}
 	else
+	#endif
 	{
 		// otherwise do default processing
 		// put received char in buffer
@@ -279,5 +481,14 @@ UART_INTERRUPT_HANDLER(SIG_UART_RECV)
 			// count overflow
 			uartRxOverflow++;
 		}
+		#ifdef UART_FLOWCONTROL
+		// ask the sender to pause before the buffer overflows
+		if(uartFlowMode && !uartRxThrottled &&
+			(uartRxBuffer.datalength >= UART_RX_HIGH_WATER))
+		{
+			uartRxThrottle(TRUE);
+		}
+		#endif
 	}
+	#endif
 }
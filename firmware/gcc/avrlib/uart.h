@@ -57,6 +57,7 @@
 
 #include "global.h"
 #include "buffer.h"
+#include "stream.h"
 
 //! Default uart baud rate.
 /// This is the default speed after a uartInit() command,
@@ -87,6 +88,46 @@
 	#define UART_RX_BUFFER_ADDR	0x1100
 #endif
 
+// flow control
+// define UART_FLOWCONTROL in your project's global.h to compile in support
+// for hardware (RTS/CTS) and software (XON/XOFF) flow control, then select
+// the mode at run-time with uartSetFlowControl()
+#ifdef UART_FLOWCONTROL
+// flow control modes (may be OR'd together)
+#define UART_FLOW_NONE			0x00	///< no flow control
+#define UART_FLOW_RTSCTS		0x01	///< hardware flow control on RTS/CTS pins
+#define UART_FLOW_XONXOFF		0x02	///< software flow control with XON/XOFF characters
+
+// flow control characters
+#define UART_XON				0x11	///< XON (DC1) resume character
+#define UART_XOFF				0x13	///< XOFF (DC3) pause character
+
+#ifndef UART_RX_HIGH_WATER
+//! Receive buffer level at which the sender is asked to stop.
+/// Leave enough room above this level for the bytes the sender
+/// may still have in flight when it sees RTS drop or the XOFF.
+#define UART_RX_HIGH_WATER		(UART_RX_BUFFER_SIZE-(UART_RX_BUFFER_SIZE/4))
+#endif
+#ifndef UART_RX_LOW_WATER
+//! Receive buffer level at which the sender is allowed to resume.
+#define UART_RX_LOW_WATER		(UART_RX_BUFFER_SIZE/4)
+#endif
+
+#ifndef UART_RTS_PORT
+// RTS output pin (driven low when we are ready to receive)
+#define UART_RTS_PORT			PORTD	///< UART RTS Port
+#define UART_RTS_DDR			DDRD	///< UART RTS DDR
+#define UART_RTS_PIN			PD4		///< UART RTS Pin
+#endif
+#ifndef UART_CTS_PORT
+// CTS input pin (held low by the remote end when it is ready to receive)
+#define UART_CTS_PORT			PORTD	///< UART CTS Port
+#define UART_CTS_DDR			DDRD	///< UART CTS DDR
+#define UART_CTS_PORTIN			PIND	///< UART CTS Port Input
+#define UART_CTS_PIN			PD5		///< UART CTS Pin
+#endif
+#endif
+
 //! Type of interrupt handler to use for uart interrupts.
 /// Value may be SIGNAL or INTERRUPT.
 /// \warning Do not change unless you know what you're doing.
@@ -168,9 +209,14 @@ void uartInit(void);
 /// Automatically called from uartInit()
 void uartInitBuffers(void);
 
+#ifndef UART_STATIC_DISPATCH
 //! Redirects received data to a user function.
-///
+/// \note To save the receive interrupt the function pointer call, bind the
+/// function at build time instead by defining UART_RX_HANDLER to its name
+/// in your project's global.h (it must be declared there).  Defining
+/// UART_STATIC_DISPATCH removes this function and the pointer altogether.
 void uartSetRxHandler(void (*rx_func)(unsigned char c));
+#endif
 
 //! Sets the uart baud rate.
 /// Argument should be in bits-per-second, like \c uartSetBaudRate(9600);
@@ -226,6 +272,23 @@ void uartSendTxBuffer(void);
 ///	\param nBytes	length of data (number of bytes to sent)
 u08  uartSendBuffer(char *buffer, u16 nBytes);
 
+//! Byte-stream operations for the uart.
+/// Use with streamInit() - example: \c streamInit(&myStream, &uartStreamOps);
+extern const StreamOps uartStreamOps;
+
+#ifdef UART_FLOWCONTROL
+//! Selects the flow control mode.
+/// \param mode	UART_FLOW_NONE, or any combination of UART_FLOW_RTSCTS
+///				and UART_FLOW_XONXOFF.
+/// \note With XON/XOFF enabled, received XON/XOFF characters are
+/// consumed by the driver and never appear in the receive buffer,
+/// so do not use it for binary transfers.
+/// \note Buffered transmission that was paused by CTS is resumed the next
+/// time uartReceiveByte() or uartSendTxBuffer() is called, so call one of
+/// them from your main loop.
+void uartSetFlowControl(u08 mode);
+#endif
+
 #endif
 //@}
 
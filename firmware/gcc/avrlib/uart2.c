@@ -32,6 +32,13 @@ volatile u08   uartBufferedTx[2];
 cBuffer uartRxBuffer[2];
 cBuffer uartTxBuffer[2];
 unsigned short uartRxOverflow[2];
+#ifdef UART_FLOWCONTROL
+volatile u08   uartFlowMode[2];			///< flow control mode (UART_FLOW_xxx)
+volatile u08   uartRxThrottled[2];		///< TRUE when we have asked the sender to stop
+volatile u08   uartTxStopped[2];		///< TRUE when the remote end has sent XOFF
+volatile u08   uartTxHeld[2];			///< TRUE when buffered tx is paused by flow control
+volatile u08   uartTxFlowChar[2];		///< XON/XOFF waiting to be sent (0 if none)
+#endif
 #ifndef UART_BUFFER_EXTERNAL_RAM
 	// using internal ram,
 	// automatically allocate space in ram for each buffer
@@ -44,6 +51,15 @@ unsigned short uartRxOverflow[2];
 typedef void (*voidFuncPtru08)(unsigned char);
 volatile static voidFuncPtru08 UartRxFunc[2];
 
+// byte-stream operations
+const StreamOps uart0StreamOps = {uart0SendByte, uart0GetByte, uart0GetRxBuffer, uart0FlushReceiveBuffer};
+const StreamOps uart1StreamOps = {uart1SendByte, uart1GetByte, uart1GetRxBuffer, uart1FlushReceiveBuffer};
+
+#ifdef UART_FLOWCONTROL
+static void uartRxRelease(u08 nUart);
+static void uartTxResume(u08 nUart);
+#endif
+
 void uartInit(void)
 {
 	// initialize both uarts
@@ -66,6 +82,10 @@ void uart0Init(void)
 	uartBufferedTx[0] = FALSE;
 	// clear overflow count
 	uartRxOverflow[0] = 0;
+	#ifdef UART_FLOWCONTROL
+	// no flow control until requested
+	uartSetFlowControl(0, UART_FLOW_NONE);
+	#endif
 	// enable interrupts
 	sei();
 }
@@ -85,6 +105,10 @@ void uart1Init(void)
 	uartBufferedTx[1] = FALSE;
 	// clear overflow count
 	uartRxOverflow[1] = 0;
+	#ifdef UART_FLOWCONTROL
+	// no flow control until requested
+	uartSetFlowControl(1, UART_FLOW_NONE);
+	#endif
 	// enable interrupts
 	sei();
 }
@@ -151,14 +175,186 @@ cBuffer* uartGetRxBuffer(u08 nUart)
 	return &uartRxBuffer[nUart];
 }
 
+cBuffer* uart0GetRxBuffer(void)
+{
+	return &uartRxBuffer[0];
+}
+
+cBuffer* uart1GetRxBuffer(void)
+{
+	return &uartRxBuffer[1];
+}
+
 cBuffer* uartGetTxBuffer(u08 nUart)
 {
 	// return tx buffer pointer
 	return &uartTxBuffer[nUart];
 }
 
+#ifdef UART_FLOWCONTROL
+void uartSetFlowControl(u08 nUart, u08 mode)
+{
+	u08 sreg = SREG;
+	cli();
+	uartFlowMode[nUart] = mode;
+	// reset flow control state
+	uartRxThrottled[nUart] = FALSE;
+	uartTxStopped[nUart] = FALSE;
+	uartTxHeld[nUart] = FALSE;
+	uartTxFlowChar[nUart] = 0;
+	if(mode & UART_FLOW_RTSCTS)
+	{
+		// RTS is an output, asserted (low) to accept data
+		// CTS is an input
+		if(nUart)
+		{
+			cbi(UART1_RTS_PORT, UART1_RTS_PIN);
+			sbi(UART1_RTS_DDR, UART1_RTS_PIN);
+			cbi(UART1_CTS_DDR, UART1_CTS_PIN);
+		}
+		else
+		{
+			cbi(UART0_RTS_PORT, UART0_RTS_PIN);
+			sbi(UART0_RTS_DDR, UART0_RTS_PIN);
+			cbi(UART0_CTS_DDR, UART0_CTS_PIN);
+		}
+	}
+	SREG = sreg;
+}
+
+// returns TRUE if the remote end has asked us to stop sending
+static u08 uartTxIsStopped(u08 nUart)
+{
+	if((uartFlowMode[nUart] & UART_FLOW_XONXOFF) && uartTxStopped[nUart])
+		return TRUE;
+	if(uartFlowMode[nUart] & UART_FLOW_RTSCTS)
+	{
+		if(nUart)
+			return (inb(UART1_CTS_PORTIN) & BV(UART1_CTS_PIN)) ? TRUE : FALSE;
+		else
+			return (inb(UART0_CTS_PORTIN) & BV(UART0_CTS_PIN)) ? TRUE : FALSE;
+	}
+	return FALSE;
+}
+
+// returns TRUE if the uart data register can accept a byte
+static u08 uartTxRegEmpty(u08 nUart)
+{
+	if(nUart)
+		return (inb(UCSR1A) & BV(UDRE)) ? TRUE : FALSE;
+	else
+		return (inb(UCSR0A) & BV(UDRE)) ? TRUE : FALSE;
+}
+
+// queue an XON/XOFF character ahead of any other transmit data
+// (must be called with interrupts disabled)
+static void uartSendFlowChar(u08 nUart, u08 c)
+{
+	if(uartTxRegEmpty(nUart))
+	{
+		// data register is free, send it now
+		// the transmit interrupt takes care of any held buffer
+		if(nUart)
+			outb(UDR1, c);
+		else
+			outb(UDR0, c);
+		uartTxHeld[nUart] = FALSE;
+	}
+	else
+	{
+		// send it as soon as the current byte is done
+		uartTxFlowChar[nUart] = c;
+	}
+}
+
+// ask the sender to stop (TRUE) or resume (FALSE)
+// (must be called with interrupts disabled)
+static void uartRxThrottle(u08 nUart, u08 stop)
+{
+	uartRxThrottled[nUart] = stop;
+	if(uartFlowMode[nUart] & UART_FLOW_RTSCTS)
+	{
+		if(nUart)
+		{
+			if(stop)	sbi(UART1_RTS_PORT, UART1_RTS_PIN);
+			else		cbi(UART1_RTS_PORT, UART1_RTS_PIN);
+		}
+		else
+		{
+			if(stop)	sbi(UART0_RTS_PORT, UART0_RTS_PIN);
+			else		cbi(UART0_RTS_PORT, UART0_RTS_PIN);
+		}
+	}
+	if(uartFlowMode[nUart] & UART_FLOW_XONXOFF)
+		uartSendFlowChar(nUart, stop?UART_XOFF:UART_XON);
+}
+
+// let the sender resume once the receive buffer has drained
+static void uartRxRelease(u08 nUart)
+{
+	u08 sreg = SREG;
+	cli();
+	if(uartRxThrottled[nUart] &&
+		(uartRxBuffer[nUart].datalength <= (nUart?UART1_RX_LOW_WATER:UART0_RX_LOW_WATER)))
+	{
+		uartRxThrottle(nUart, FALSE);
+	}
+	SREG = sreg;
+}
+
+// restart buffered transmission paused by flow control
+static void uartTxResume(u08 nUart)
+{
+	u08 sreg = SREG;
+	cli();
+	if(uartTxHeld[nUart] && !uartTxIsStopped(nUart))
+	{
+		uartTxHeld[nUart] = FALSE;
+		if(nUart)
+			outb(UDR1, bufferGetFromFront(&uartTxBuffer[1]));
+		else
+			outb(UDR0, bufferGetFromFront(&uartTxBuffer[0]));
+	}
+	SREG = sreg;
+}
+#endif
+
 void uartSendByte(u08 nUart, u08 txData)
 {
+	#ifdef UART_FLOWCONTROL
+	u08 sreg;
+	// wait until the remote end will accept data
+	while(uartTxIsStopped(nUart));
+	for(;;)
+	{
+		// wait for the transmitter to be ready
+		while(!uartTxRegEmpty(nUart));
+		// claim the data register atomically,
+		// the receive interrupt may use it to send XON/XOFF
+		sreg = SREG;
+		cli();
+		if(uartTxRegEmpty(nUart))
+		{
+			// a pending flow control character goes first
+			if(!uartTxFlowChar[nUart])
+				break;
+			if(nUart)
+				outb(UDR1, uartTxFlowChar[1]);
+			else
+				outb(UDR0, uartTxFlowChar[0]);
+			uartTxFlowChar[nUart] = 0;
+		}
+		SREG = sreg;
+	}
+	// send byte
+	if(nUart)
+		outb(UDR1, txData);
+	else
+		outb(UDR0, txData);
+	// set ready state to FALSE
+	uartReadyTx[nUart] = FALSE;
+	SREG = sreg;
+	#else
 	// wait for the transmitter to be ready
 //	while(!uartReadyTx[nUart]);
 	// send byte
@@ -174,6 +370,7 @@ void uartSendByte(u08 nUart, u08 txData)
 	}
 	// set ready state to FALSE
 	uartReadyTx[nUart] = FALSE;
+	#endif
 }
 
 void uart0SendByte(u08 data)
@@ -211,6 +408,10 @@ int uart1GetByte(void)
 
 u08 uartReceiveByte(u08 nUart, u08* rxData)
 {
+	#ifdef UART_FLOWCONTROL
+	// restart transmission if CTS has come back
+	uartTxResume(nUart);
+	#endif
 	// make sure we have a receive buffer
 	if(uartRxBuffer[nUart].size)
 	{
@@ -219,6 +420,10 @@ u08 uartReceiveByte(u08 nUart, u08* rxData)
 		{
 			// get byte from beginning of buffer
 			*rxData = bufferGetFromFront(&uartRxBuffer[nUart]);
+			#ifdef UART_FLOWCONTROL
+			// let the sender resume if we have made enough room
+			uartRxRelease(nUart);
+			#endif
 			return TRUE;
 		}
 		else
@@ -232,6 +437,19 @@ void uartFlushReceiveBuffer(u08 nUart)
 {
 	// flush all data from receive buffer
 	bufferFlush(&uartRxBuffer[nUart]);
+	#ifdef UART_FLOWCONTROL
+	uartRxRelease(nUart);
+	#endif
+}
+
+void uart0FlushReceiveBuffer(void)
+{
+	uartFlushReceiveBuffer(0);
+}
+
+void uart1FlushReceiveBuffer(void)
+{
+	uartFlushReceiveBuffer(1);
 }
 
 u08 uartReceiveBufferIsEmpty(u08 nUart)
@@ -257,6 +475,14 @@ void uart1AddToTxBuffer(u08 data)
 
 void uartSendTxBuffer(u08 nUart)
 {
+	#ifdef UART_FLOWCONTROL
+	// buffered transmit is already running (paused by flow control)
+	if(uartBufferedTx[nUart])
+	{
+		uartTxResume(nUart);
+		return;
+	}
+	#endif
 	// turn on buffered transmit
 	uartBufferedTx[nUart] = TRUE;
 	// send the first byte to get things going by interrupts
@@ -296,12 +522,32 @@ u08 uartSendBuffer(u08 nUart, char *buffer, u16 nBytes)
 // UART Transmit Complete Interrupt Function
 void uartTransmitService(u08 nUart)
 {
+	#ifdef UART_FLOWCONTROL
+	// flow control characters go out ahead of any other data
+	if(uartTxFlowChar[nUart])
+	{
+		if(nUart)
+			outb(UDR1, uartTxFlowChar[1]);
+		else
+			outb(UDR0, uartTxFlowChar[0]);
+		uartTxFlowChar[nUart] = 0;
+		return;
+	}
+	#endif
 	// check if buffered tx is enabled
 	if(uartBufferedTx[nUart])
 	{
 		// check if there's data left in the buffer
 		if(uartTxBuffer[nUart].datalength)
 		{
+			#ifdef UART_FLOWCONTROL
+			// hold the buffer if the remote end is not ready
+			if(uartTxIsStopped(nUart))
+			{
+				uartTxHeld[nUart] = TRUE;
+				return;
+			}
+			#endif
 			// send byte from top of buffer
 			if(nUart)
 				outb(UDR1,  bufferGetFromFront(&uartTxBuffer[1]) );
@@ -334,6 +580,24 @@ void uartReceiveService(u08 nUart)
 	else
 		c = inb(UDR0);
 
+	#ifdef UART_FLOWCONTROL
+	// intercept XON/XOFF from the remote end
+	if(uartFlowMode[nUart] & UART_FLOW_XONXOFF)
+	{
+		if(c == UART_XOFF)
+		{
+			uartTxStopped[nUart] = TRUE;
+			return;
+		}
+		if(c == UART_XON)
+		{
+			uartTxStopped[nUart] = FALSE;
+			uartTxResume(nUart);
+			return;
+		}
+	}
+	#endif
+
 	// if there's a user function to handle this receive event
 	if(UartRxFunc[nUart])
 	{
@@ -351,6 +615,14 @@ void uartReceiveService(u08 nUart)
 			// count overflow
 			uartRxOverflow[nUart]++;
 		}
+		#ifdef UART_FLOWCONTROL
+		// ask the sender to pause before the buffer overflows
+		if(uartFlowMode[nUart] && !uartRxThrottled[nUart] &&
+			(uartRxBuffer[nUart].datalength >= (nUart?UART1_RX_HIGH_WATER:UART0_RX_HIGH_WATER)))
+		{
+			uartRxThrottle(nUart, TRUE);
+		}
+		#endif
 	}
 }
 
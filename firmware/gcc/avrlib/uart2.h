@@ -64,6 +64,7 @@
 
 #include "global.h"
 #include "buffer.h"
+#include "stream.h"
 
 //! Default uart baud rate.
 /// This is the default speed after a uartInit() command,
@@ -98,6 +99,61 @@
 	#define UART1_RX_BUFFER_ADDR	0x1300
 #endif
 
+// flow control
+// define UART_FLOWCONTROL in your project's global.h to compile in support
+// for hardware (RTS/CTS) and software (XON/XOFF) flow control, then select
+// the mode for each uart at run-time with uartSetFlowControl()
+#ifdef UART_FLOWCONTROL
+// flow control modes (may be OR'd together)
+#define UART_FLOW_NONE			0x00	///< no flow control
+#define UART_FLOW_RTSCTS		0x01	///< hardware flow control on RTS/CTS pins
+#define UART_FLOW_XONXOFF		0x02	///< software flow control with XON/XOFF characters
+
+// flow control characters
+#define UART_XON				0x11	///< XON (DC1) resume character
+#define UART_XOFF				0x13	///< XOFF (DC3) pause character
+
+// receive buffer levels at which the sender is asked to stop/resume
+// (leave room above the high-water mark for bytes already in flight)
+#ifndef UART0_RX_HIGH_WATER
+#define UART0_RX_HIGH_WATER		(UART0_RX_BUFFER_SIZE-(UART0_RX_BUFFER_SIZE/4))
+#endif
+#ifndef UART0_RX_LOW_WATER
+#define UART0_RX_LOW_WATER		(UART0_RX_BUFFER_SIZE/4)
+#endif
+#ifndef UART1_RX_HIGH_WATER
+#define UART1_RX_HIGH_WATER		(UART1_RX_BUFFER_SIZE-(UART1_RX_BUFFER_SIZE/4))
+#endif
+#ifndef UART1_RX_LOW_WATER
+#define UART1_RX_LOW_WATER		(UART1_RX_BUFFER_SIZE/4)
+#endif
+
+// RTS outputs (driven low when we are ready to receive)
+// CTS inputs (held low by the remote end when it is ready to receive)
+#ifndef UART0_RTS_PORT
+#define UART0_RTS_PORT			PORTD	///< UART0 RTS Port
+#define UART0_RTS_DDR			DDRD	///< UART0 RTS DDR
+#define UART0_RTS_PIN			PD4		///< UART0 RTS Pin
+#endif
+#ifndef UART0_CTS_PORT
+#define UART0_CTS_PORT			PORTD	///< UART0 CTS Port
+#define UART0_CTS_DDR			DDRD	///< UART0 CTS DDR
+#define UART0_CTS_PORTIN		PIND	///< UART0 CTS Port Input
+#define UART0_CTS_PIN			PD5		///< UART0 CTS Pin
+#endif
+#ifndef UART1_RTS_PORT
+#define UART1_RTS_PORT			PORTD	///< UART1 RTS Port
+#define UART1_RTS_DDR			DDRD	///< UART1 RTS DDR
+#define UART1_RTS_PIN			PD6		///< UART1 RTS Pin
+#endif
+#ifndef UART1_CTS_PORT
+#define UART1_CTS_PORT			PORTD	///< UART1 CTS Port
+#define UART1_CTS_DDR			DDRD	///< UART1 CTS DDR
+#define UART1_CTS_PORTIN		PIND	///< UART1 CTS Port Input
+#define UART1_CTS_PIN			PD7		///< UART1 CTS Pin
+#endif
+#endif
+
 //! Type of interrupt handler to use for uart interrupts.
 /// Value may be SIGNAL or INTERRUPT.
 /// \warning Do not change unless you know what you're doing.
@@ -152,6 +208,10 @@ void uartSetBaudRate(u08 nUart, u32 baudrate);
 ///
 cBuffer* uartGetRxBuffer(u08 nUart);
 
+//! GetRxBuffer commands with the UART number hardcoded
+cBuffer* uart0GetRxBuffer(void);
+cBuffer* uart1GetRxBuffer(void);
+
 //! Returns pointer to the transmit buffer structure.
 ///
 cBuffer* uartGetTxBuffer(u08 nUart);
@@ -188,6 +248,10 @@ u08 uartReceiveBufferIsEmpty(u08 nUart);
 ///
 void uartFlushReceiveBuffer(u08 nUart);
 
+//! FlushReceiveBuffer commands with the UART number hardcoded
+void uart0FlushReceiveBuffer(void);
+void uart1FlushReceiveBuffer(void);
+
 //! Add byte to end of uart Tx buffer.
 ///
 void uartAddToTxBuffer(u08 nUart, u08 data);
@@ -205,6 +269,23 @@ void uartSendTxBuffer(u08 nUart);
 ///
 u08 uartSendBuffer(u08 nUart, char *buffer, u16 nBytes);
 
+#ifdef UART_FLOWCONTROL
+//! Selects the flow control mode for a uart.
+/// \param mode	UART_FLOW_NONE, or any combination of UART_FLOW_RTSCTS
+///				and UART_FLOW_XONXOFF.
+/// \note With XON/XOFF enabled, received XON/XOFF characters are
+/// consumed by the driver and never appear in the receive buffer,
+/// so do not use it for binary transfers.
+/// \note Buffered transmission that was paused by CTS is resumed the next
+/// time uartReceiveByte() or uartSendTxBuffer() is called for that uart.
+void uartSetFlowControl(u08 nUart, u08 mode);
+#endif
+
+//! Byte-stream operations for each uart.
+/// Use with streamInit() - example: \c streamInit(&myStream, &uart1StreamOps);
+extern const StreamOps uart0StreamOps;
+extern const StreamOps uart1StreamOps;
+
 //! interrupt service handlers
 void uartTransmitService(u08 nUart);
 void uartReceiveService(u08 nUart);
@@ -21,6 +21,12 @@
 #include "global.h"
 #include "timer.h"
 #include "uartsw.h"
+#include "isrstat.h"
+
+#ifndef CRITICAL_SECTION_START
+#define CRITICAL_SECTION_START	unsigned char _sreg = SREG; cli()
+#define CRITICAL_SECTION_END	SREG = _sreg
+#endif
 
 // Program ROM constants
 
@@ -33,16 +39,51 @@ static volatile u08 UartswTxBitNum;
 
 // baud rate common to transmit and receive
 static volatile u16 UartswBaudRateDiv;
+// delay from the start bit edge to the middle of the first data bit
+static volatile u16 UartswRxStartDelay;
 
 // uartsw receive status and data variables
 static volatile u08 UartswRxBusy;
 static volatile u08 UartswRxData;
 static volatile u08 UartswRxBitNum;
+// receive error counters
+static volatile u16 UartswRxFrameErrors;
+static volatile u16 UartswRxOverflow;
 // receive buffer
 static cBuffer uartswRxBuffer;               ///< uartsw receive buffer
 // automatically allocate space in ram for each buffer
 static char uartswRxData[UARTSW_RX_BUFFER_SIZE];
 
+#ifdef UARTSW_JITTER_STATS
+// worst-case bit service latency, in timer tics after the scheduled compare
+static volatile u16 UartswTxLateMax;
+static volatile u16 UartswRxLateMax;
+#endif
+
+// line levels
+#ifdef UARTSW_INVERT
+#define UARTSW_MARK		0
+#define UARTSW_SPACE	1
+#else
+#define UARTSW_MARK		1
+#define UARTSW_SPACE	0
+#endif
+
+#ifdef UARTSW_TX_OC1A
+// edges are made by the hardware at each compare match, so each bit
+// is programmed one match ahead (+1 for stop bit, +1 for end of stop bit)
+#define UARTSW_TX_BITS	10
+// have the OC1A hardware drive <level> onto the pin at the next compare match
+#define uartswTxSetLevel(level)	\
+	outb(TCCR1A, (inb(TCCR1A) & ~BV(COM1A0)) | BV(COM1A1) | ((level)?BV(COM1A0):0))
+#else
+// bits are driven as each compare match is serviced (+1 for stop bit)
+#define UARTSW_TX_BITS	9
+// drive <level> onto the pin now
+#define uartswTxSetLevel(level)	\
+	do { if(level) sbi(UARTSW_TX_PORT, UARTSW_TX_PIN); else cbi(UARTSW_TX_PORT, UARTSW_TX_PIN); } while(0)
+#endif
+
 // functions
 
 //! enable and initialize the software uart
@@ -51,6 +92,13 @@ void uartswInit(void)
     // initialize the buffers
 	uartswInitBuffers();
 	// initialize the ports
+	#ifdef UARTSW_TX_OC1A
+	// force the OC1A output to the idle (mark) level before enabling it
+	uartswTxSetLevel(UARTSW_MARK);
+	sbi(TCCR1A, FOC1A);
+	#else
+	uartswTxSetLevel(UARTSW_MARK);
+	#endif
 	sbi(UARTSW_TX_DDR, UARTSW_TX_PIN);
 	cbi(UARTSW_RX_DDR, UARTSW_RX_PIN);
 	cbi(UARTSW_RX_PORT, UARTSW_RX_PIN);
@@ -66,12 +114,14 @@ void uartswInit(void)
 
 	// setup the receiver
 	UartswRxBusy = FALSE;
+	UartswRxFrameErrors = 0;
+	UartswRxOverflow = 0;
 	// disable OC1B interrupt
 	cbi(TIMSK, OCIE1B);
 	// attach RxBit service routine to OC1B
 	timerAttach(TIMER1OUTCOMPAREB_INT, uartswRxBitService);
-	// attach RxBit service routine to ICP
-	timerAttach(TIMER1INPUTCAPTURE_INT, uartswRxBitService);
+	// attach RxStart service routine to ICP
+	timerAttach(TIMER1INPUTCAPTURE_INT, uartswRxStartService);
 	#ifdef UARTSW_INVERT 
 	// trigger on rising edge 
 	sbi(TCCR1B, ICES1); 
@@ -79,9 +129,14 @@ void uartswInit(void)
 	// trigger on falling edge 
 	cbi(TCCR1B, ICES1); 
 	#endif	
-	// enable ICP interrupt
+	// clear any stale capture and enable ICP interrupt
+	outb(TIFR, BV(ICF1));
 	sbi(TIMSK, TICIE1);
 
+	#ifdef UARTSW_JITTER_STATS
+	uartswClearJitter();
+	#endif
+
 	// turn on interrupts
 	sei();
 }
@@ -100,6 +155,10 @@ void uartswOff(void)
 	cbi(TIMSK, OCIE1A);
 	cbi(TIMSK, OCIE1B);
 	cbi(TIMSK, TICIE1);
+	#ifdef UARTSW_TX_OC1A
+	// disconnect OC1A from the pin
+	outb(TCCR1A, inb(TCCR1A) & ~(BV(COM1A1)|BV(COM1A0)));
+	#endif
 	// detach the service routines
 	timerDetach(TIMER1OUTCOMPAREA_INT);
 	timerDetach(TIMER1OUTCOMPAREB_INT);
@@ -112,6 +171,8 @@ void uartswSetBaudRate(u32 baudrate)
 	timer1SetPrescaler(TIMER_CLK_DIV1);
 	// calculate division factor for requested baud rate, and set it
 	UartswBaudRateDiv = (u16)((F_CPU+(baudrate/2L))/(baudrate*1L));
+	// first data bit is sampled 1.5 bit periods after the start bit edge
+	UartswRxStartDelay = UartswBaudRateDiv + UartswBaudRateDiv/2;
 }
 
 //! returns the receive buffer structure 
@@ -129,20 +190,28 @@ void uartswSendByte(u08 data)
 	UartswTxBusy = TRUE;
 	// save data
 	UartswTxData = data;
-	// set number of bits (+1 for stop bit)
-	UartswTxBitNum = 9;
-	
-	// set the start bit
-	#ifdef UARTSW_INVERT
-	sbi(UARTSW_TX_PORT, UARTSW_TX_PIN);
+	// set number of bits to schedule
+	UartswTxBitNum = UARTSW_TX_BITS;
+
+	// an interrupt between reading TCNT1 and writing OCR1A could put the
+	// compare behind the counter, delaying the first edge a whole timer wrap
+	CRITICAL_SECTION_START;
+	#ifdef UARTSW_TX_OC1A
+	// let the hardware produce the start bit edge a few tics from now,
+	// every later edge is also produced by the hardware on an exact
+	// multiple of the bit period, regardless of interrupt latency
+	uartswTxSetLevel(UARTSW_SPACE);
+	outw(OCR1A, inw(TCNT1) + UARTSW_TX_LEAD);
 	#else
-	cbi(UARTSW_TX_PORT, UARTSW_TX_PIN);
-	#endif
-
+	// set the start bit
+	uartswTxSetLevel(UARTSW_SPACE);
 	// schedule the next bit
 	outw(OCR1A, inw(TCNT1) + UartswBaudRateDiv);
-	// enable OC1A interrupt
+	#endif
+	// clear any stale OC1A match and enable OC1A interrupt
+	outb(TIFR, BV(OCF1A));
 	sbi(TIMSK, OCIE1A);
+	CRITICAL_SECTION_END;
 }
 
 //! gets a byte (if available) from the uart receive buffer
@@ -171,33 +240,76 @@ u08 uartswReceiveByte(u08* rxData)
 	}
 }
 
+//! gets a byte (if available) from the uart receive buffer (getchar-style)
+int uartswGetByte(void)
+{
+	u08 c;
+	if(uartswReceiveByte(&c))
+		return c;
+	else
+		return -1;
+}
+
+//! flushes (deletes) all data from the receive buffer
+void uartswFlushReceiveBuffer(void)
+{
+	bufferFlush(&uartswRxBuffer);
+}
+
+// byte-stream operations
+const StreamOps uartswStreamOps = {uartswSendByte, uartswGetByte, uartswGetRxBuffer, uartswFlushReceiveBuffer};
+
+//! returns the number of bytes received with a bad stop bit
+u16 uartswGetFrameErrors(void)
+{
+	return UartswRxFrameErrors;
+}
+
+//! returns the number of bytes lost to a full receive buffer
+u16 uartswGetRxOverflow(void)
+{
+	return UartswRxOverflow;
+}
+
+#ifdef UARTSW_JITTER_STATS
+//! reports the worst-case bit service latency seen since the last clear
+void uartswGetJitter(u16* txLateMax, u16* rxLateMax)
+{
+	*txLateMax = UartswTxLateMax;
+	*rxLateMax = UartswRxLateMax;
+}
+
+//! clears the bit service latency statistics
+void uartswClearJitter(void)
+{
+	UartswTxLateMax = 0;
+	UartswRxLateMax = 0;
+}
+#endif
+
 void uartswTxBitService(void)
 {
+	#ifdef UARTSW_JITTER_STATS
+	// how late are we relative to the edge we just serviced
+	u16 late = inw(TCNT1) - inw(OCR1A);
+	if(late > UartswTxLateMax)
+		UartswTxLateMax = late;
+	#endif
+
 	if(UartswTxBitNum)
 	{
 		// there are bits still waiting to be transmitted
-		if(UartswTxBitNum > 1)
+		if(UartswTxBitNum > (UARTSW_TX_BITS-8))
 		{
-			// transmit data bits (inverted, LSB first)
-			#ifdef UARTSW_INVERT
-			if( !(UartswTxData & 0x01) )
-			#else
-			if( (UartswTxData & 0x01) )
-			#endif
-				sbi(UARTSW_TX_PORT, UARTSW_TX_PIN);
-			else
-				cbi(UARTSW_TX_PORT, UARTSW_TX_PIN);
+			// transmit data bits (LSB first)
+			uartswTxSetLevel( (UartswTxData & 0x01)?UARTSW_MARK:UARTSW_SPACE );
 			// shift bits down
 			UartswTxData = UartswTxData>>1;
 		}
 		else
 		{
 			// transmit stop bit
-			#ifdef UARTSW_INVERT
-			cbi(UARTSW_TX_PORT, UARTSW_TX_PIN);
-			#else
-			sbi(UARTSW_TX_PORT, UARTSW_TX_PIN);
-			#endif
+			uartswTxSetLevel(UARTSW_MARK);
 		}
 		// schedule the next bit
 		outw(OCR1A, inw(OCR1A) + UartswBaudRateDiv);
@@ -207,73 +319,91 @@ void uartswTxBitService(void)
 	else
 	{
 		// transmission is done
+		// disable OC1A interrupt
+		cbi(TIMSK, OCIE1A);
 		// clear busy flag
 		UartswTxBusy = FALSE;
 	}
 }
 
+void uartswRxStartService(void)
+{
+	// this function runs on the start bit edge (ICP)
+	// schedule data bit sampling 1.5 bit periods from the captured
+	// edge time, so the sample point does not depend on how long
+	// it took us to get here
+	outw(OCR1B, inw(ICR1) + UartswRxStartDelay);
+	// clear OC1B interrupt flag
+	outb(TIFR, BV(OCF1B));
+	// enable OC1B interrupt
+	sbi(TIMSK, OCIE1B);
+	// disable ICP interrupt
+	cbi(TIMSK, TICIE1);
+	// set start bit flag
+	UartswRxBusy = TRUE;
+	// reset bit counter
+	UartswRxBitNum = 0;
+	// reset data
+	UartswRxData = 0;
+}
+
 void uartswRxBitService(void)
 {
-	// this function runs on either:
-	// - a rising edge interrupt
-	// - OC1B
-	if(!UartswRxBusy)
-	{
-		// this is a start bit
-		// disable ICP interrupt
-		cbi(TIMSK, TICIE1);
-		// schedule data bit sampling 1.5 bit periods from now
-		outw(OCR1B, inw(TCNT1) + UartswBaudRateDiv + UartswBaudRateDiv/2);
-		// clear OC1B interrupt flag
-		sbi(TIFR, OCF1B);
-		// enable OC1B interrupt
-		sbi(TIMSK, OCIE1B);
-		// set start bit flag
-		UartswRxBusy = TRUE;
-		// reset bit counter
-		UartswRxBitNum = 0;
-		// reset data
-		UartswRxData = 0;
-	}
-	else
+	u08 bit;
+
+	// this function runs on OC1B in the middle of each bit
+
+	#ifdef UARTSW_JITTER_STATS
+	// how late are we relative to the intended sample point
+	u16 late = inw(TCNT1) - inw(OCR1B);
+	if(late > UartswRxLateMax)
+		UartswRxLateMax = late;
+	#endif
+
+	// sample the data line
+	bit = (inb(UARTSW_RX_PORTIN) & (1<<UARTSW_RX_PIN)) ? 1 : 0;
+	#ifdef UARTSW_INVERT
+	bit ^= 1;
+	#endif
+
+	if(UartswRxBitNum < 8)
 	{
-		// start bit has already been received
 		// we're in the data bits
-		
 		// shift data byte to make room for new bit
 		UartswRxData = UartswRxData>>1;
-
-		// sample the data line
-		#ifdef UARTSW_INVERT
-		if( !(inb(UARTSW_RX_PORTIN) & (1<<UARTSW_RX_PIN)) )
-		#else
-		if( (inb(UARTSW_RX_PORTIN) & (1<<UARTSW_RX_PIN)) )
-		#endif
+		if(bit)
 		{
 			// serial line is marking
 			// record '1' bit
 			UartswRxData |= 0x80;
 		}
-
 		// increment bit counter
 		UartswRxBitNum++;
 		// schedule next bit sample
 		outw(OCR1B, inw(OCR1B) + UartswBaudRateDiv);
-
-		// check if we have a full byte
-		if(UartswRxBitNum >= 8)
+	}
+	else
+	{
+		// this is the stop bit
+		if(bit)
 		{
 			// save data in receive buffer
-			bufferAddToEnd(&uartswRxBuffer, UartswRxData);
-			// disable OC1B interrupt
-			cbi(TIMSK, OCIE1B);
-			// clear ICP interrupt flag
-			sbi(TIFR, ICF1);
-			// enable ICP interrupt
-			sbi(TIMSK, TICIE1);
-			// clear start bit flag
-			UartswRxBusy = FALSE;
+			if(!bufferAddToEnd(&uartswRxBuffer, UartswRxData))
+				UartswRxOverflow++;
+		}
+		else
+		{
+			// no stop bit, drop the byte
+			UartswRxFrameErrors++;
 		}
+		// disable OC1B interrupt
+		cbi(TIMSK, OCIE1B);
+		// clear ICP interrupt flag
+		outb(TIFR, BV(ICF1));
+		// enable ICP interrupt
+		sbi(TIMSK, TICIE1);
+		// clear start bit flag
+		UartswRxBusy = FALSE;
 	}
 }
 
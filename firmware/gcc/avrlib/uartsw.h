@@ -26,10 +26,24 @@
 ///	UART is enabled.  The overflow interrupt from Timer1 can still be used for
 ///	other timing, but the prescaler for Timer1 must not be changed.
 ///
-///	Serial output from this UART can be routed to any I/O pin.  Serial input
-///	for this UART must come from the Timer1 Input Capture (IC1) I/O pin.
-///	These options should be configured by editing your local copy of
-///	"uartswconf.h".
+///	Transmit and receive run independently on the free-running Timer1 count,
+///	so the UART is full-duplex.  Each bit time is scheduled as an exact
+///	multiple of the bit period from the start of the byte, so interrupt
+///	latency does not accumulate from bit to bit.  The start bit edge is
+///	timestamped by the Input Capture hardware and the data bits are sampled
+///	in the middle of each bit relative to that timestamp.
+///
+///	Serial output from this UART can be routed to any I/O pin.  If it is
+///	routed to the OC1A pin and UARTSW_TX_OC1A is defined, the output compare
+///	hardware makes the transmit edges, which removes transmit jitter entirely
+///	and lets the transmit interrupt be serviced up to a full bit period late.
+///	Serial input for this UART must come from the Timer1 Input Capture (IC1)
+///	I/O pin.  These options should be configured by editing your local copy
+///	of "uartswconf.h".
+///
+///	At 12MHz, 38400 baud full-duplex is practical with transmit on OC1A.
+///	Define UARTSW_JITTER_STATS to record the worst-case bit service latency
+///	(see uartswGetJitter()) when checking a new baud rate or interrupt load.
 //
 // This code is distributed under the GNU Public License
 //		which can be found at http://www.gnu.org/licenses/gpl.txt
@@ -41,12 +55,19 @@
 
 #include "global.h"
 #include "buffer.h"
+#include "stream.h"
 
 // include configuration
 #include "uartswconf.h"
 
 // constants/macros/typdefs
 
+#ifndef UARTSW_TX_LEAD
+//! Timer tics from uartswSendByte() to the start bit edge when
+/// transmitting on OC1A (must cover the time to program the compare).
+#define UARTSW_TX_LEAD			32
+#endif
+
 // functions
 
 //! enable and initialize the software uart
@@ -70,8 +91,37 @@ void uartswSendByte(u08 data);
 // uartswReceiveByte( &myReceivedByte );
 u08 uartswReceiveByte(u08* rxData);
 
+//! gets a single byte from the uart receive buffer
+// Returns the byte, or -1 if no byte is available (getchar-style).
+int uartswGetByte(void);
+
+//! flushes (deletes) all data from the receive buffer
+void uartswFlushReceiveBuffer(void);
+
+//! byte-stream operations for the software uart
+// use with streamInit() - example: streamInit(&myStream, &uartswStreamOps);
+extern const StreamOps uartswStreamOps;
+
+//! returns the number of bytes received with a bad stop bit
+u16 uartswGetFrameErrors(void);
+//! returns the number of bytes lost to a full receive buffer
+u16 uartswGetRxOverflow(void);
+
+#ifdef UARTSW_JITTER_STATS
+//! reports the worst-case bit service latency since the last clear
+// Both values are in timer tics (CPU cycles) after the scheduled
+// compare match.  Receive sampling is safe while rxLateMax stays well
+// below a quarter bit period.  With UARTSW_TX_OC1A, transmit is safe
+// while txLateMax stays below a full bit period.
+void uartswGetJitter(u16* txLateMax, u16* rxLateMax);
+//! clears the bit service latency statistics
+void uartswClearJitter(void);
+#endif
+
 //! internal transmit bit handler
 void uartswTxBitService(void);
+//! internal receive start bit handler
+void uartswRxStartService(void);
 //! internal receive bit handler
 void uartswRxBitService(void);
 
@@ -191,6 +191,25 @@ u08 uartswReceiveByte(u08* rxData)
 	}
 }
 
+//! gets a byte (if available) from the uart receive buffer (getchar-style)
+int uartswGetByte(void)
+{
+	u08 c;
+	if(uartswReceiveByte(&c))
+		return c;
+	else
+		return -1;
+}
+
+//! flushes (deletes) all data from the receive buffer
+void uartswFlushReceiveBuffer(void)
+{
+	bufferFlush(&uartswRxBuffer);
+}
+
+// byte-stream operations
+const StreamOps uartswStreamOps = {uartswSendByte, uartswGetByte, uartswGetRxBuffer, uartswFlushReceiveBuffer};
+
 void uartswTxBitService(void)
 {
 	if(UartswTxBitNum)
@@ -42,6 +42,7 @@
 
 #include "global.h"
 #include "buffer.h"
+#include "stream.h"
 
 // include configuration
 #include "uartsw2conf.h"
@@ -71,6 +72,17 @@ void uartswSendByte(u08 data);
 // uartswReceiveByte( &myReceivedByte );
 u08 uartswReceiveByte(u08* rxData);
 
+//! gets a single byte from the uart receive buffer
+// Returns the byte, or -1 if no byte is available (getchar-style).
+int uartswGetByte(void);
+
+//! flushes (deletes) all data from the receive buffer
+void uartswFlushReceiveBuffer(void);
+
+//! byte-stream operations for the software uart
+// use with streamInit() - example: streamInit(&myStream, &uartswStreamOps);
+extern const StreamOps uartswStreamOps;
+
 //! internal transmit bit handler
 void uartswTxBitService(void);
 //! internal receive bit handler
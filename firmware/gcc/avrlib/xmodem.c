@@ -35,6 +35,25 @@ void xmodemInit(void (*sendbyte_func)(unsigned char c), int (*getbyte_func)(void
 	xmodemIn = getbyte_func;
 }
 
+// stream I/O (when initialized with xmodemInitStream)
+static Stream* xmodemStream;
+
+static void xmodemStreamOut(unsigned char c)
+{
+	streamWrite(xmodemStream, c);
+}
+
+static int xmodemStreamIn(void)
+{
+	return streamRead(xmodemStream);
+}
+
+void xmodemInitStream(Stream* stream)
+{
+	xmodemStream = stream;
+	xmodemInit(xmodemStreamOut, xmodemStreamIn);
+}
+
 long xmodemReceive( int (*write)(unsigned char* buffer, int size) )
 {
 	// create xmodem buffer
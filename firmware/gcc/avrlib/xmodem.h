@@ -32,6 +32,8 @@
 
 #ifndef XMODEM_H
 #define XMODEM_H
+
+#include "stream.h"
 
 // xmodem control characters
 #define SOH			0x01
@@ -55,6 +57,9 @@
 //! initialize xmodem stream I/O routines
 void xmodemInit(void (*sendbyte_func)(unsigned char c), int (*getbyte_func)(void));
 
+//! initialize xmodem to use a byte-stream for I/O
+void xmodemInitStream(Stream* stream);
+
 //! xmodem receive
 long xmodemReceive( int (*write)(unsigned char* buffer, int size) );
 
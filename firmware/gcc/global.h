@@ -43,5 +43,11 @@
 #define TIMER_PRESCALE		1024
 #define TIMER_INTERVAL		(F_CPU/TIMER_PRESCALE/100)	// 100ms interval
 
+// interrupt handlers bound at build time (no run-time attach)
+#define TIMER_STATIC_DISPATCH
+#define UART_STATIC_DISPATCH
+void systickHandler(void);
+#define TIMER2OVERFLOW_HANDLER	systickHandler
+
 
 #endif
@@ -60,8 +60,8 @@ int main(void)
 
 
 	// initialize systick timer
+	// (systickHandler is bound to the timer2 overflow in global.h)
 	timer2SetPrescaler(TIMERRTC_CLK_DIV1024);
-	timerAttach(TIMER2OVERFLOW_INT, systickHandler);
 
 	// set status LED pins to output
 	sbi(DDRB, 1);